@@ -0,0 +1,109 @@
+// Ratio and speed of the RLE and LZ4 encoders in src/imagecompression.cpp on
+// RGB565 panel images.
+//
+// Uses a flat UI screen (solid panels, a gradient header and a few buttons)
+// and a noisy full-color field as the worst case. Each image is encoded to
+// RGB565 first, the way the converter feeds the compressors.
+
+#include "imagecompression.h"
+#include "pixelkernels.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <random>
+#include <vector>
+
+namespace {
+
+constexpr int kWidth = 170;
+constexpr int kHeight = 320;
+constexpr int kPixels = kWidth * kHeight;
+
+typedef std::vector<uint8_t> Bytes;
+
+void fillRect(Bytes &img, int x0, int y0, int x1, int y1, uint8_t r, uint8_t g,
+              uint8_t b) {
+  for (int y = y0; y <= y1; ++y) {
+    for (int x = x0; x <= x1; ++x) {
+      uint8_t *p = &img[size_t(y * kWidth + x) * 4];
+      p[0] = r;
+      p[1] = g;
+      p[2] = b;
+    }
+  }
+}
+
+Bytes flatUiImage() {
+  Bytes img(size_t(kPixels) * 4, 255);
+  fillRect(img, 0, 0, kWidth - 1, kHeight - 1, 30, 34, 40);
+  for (int y = 0; y < 40; ++y) {
+    fillRect(img, 0, y, kWidth - 1, y, uint8_t(40 + y * 2), 90, 160);
+  }
+  for (int i = 0; i < 4; ++i) {
+    const int top = 60 + i * 60;
+    fillRect(img, 10, top, kWidth - 11, top + 44, 60, 66, 76);
+    fillRect(img, 20, top + 12, 60, top + 32, 0, 200, 120);
+  }
+  return img;
+}
+
+Bytes noiseImage() {
+  Bytes img(size_t(kPixels) * 4, 255);
+  std::mt19937 rng(7);
+  std::uniform_int_distribution<int> value(0, 255);
+  for (int i = 0; i < kPixels; ++i) {
+    img[size_t(i) * 4] = uint8_t(value(rng));
+    img[size_t(i) * 4 + 1] = uint8_t(value(rng));
+    img[size_t(i) * 4 + 2] = uint8_t(value(rng));
+  }
+  return img;
+}
+
+double millisecondsPerRun(const std::function<void()> &run) {
+  int runs = 0;
+  double seconds = 0.0;
+  const auto start = std::chrono::steady_clock::now();
+  do {
+    run();
+    ++runs;
+    seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                            start)
+                  .count();
+  } while (seconds < 0.2);
+  return seconds * 1000.0 / runs;
+}
+
+void bench(const char *name, const Bytes &rgb565,
+           const std::function<Bytes()> &compress) {
+  Bytes out;
+  const double ms = millisecondsPerRun([&]() { out = compress(); });
+  std::printf("  %-6s %9zu bytes %7.1f%% %9.3f ms\n", name, out.size(),
+              100.0 * double(out.size()) / double(rgb565.size()), ms);
+}
+
+} // namespace
+
+int main() {
+  const struct {
+    const char *name;
+    Bytes pixels;
+  } images[] = {{"flat UI", flatUiImage()}, {"noise", noiseImage()}};
+
+  for (const auto &image : images) {
+    Bytes rgb565(size_t(kPixels) * 2);
+    PixelKernels::rgba8888ToRgb565(image.pixels.data(), rgb565.data(),
+                                   kPixels);
+
+    std::printf("%s (%zu bytes RGB565)\n", image.name, rgb565.size());
+    bench("RLE", rgb565, [&]() {
+      return ImageCompression::rleCompress(rgb565.data(), rgb565.size(), 2);
+    });
+    bench("LZ4", rgb565, [&]() {
+      return ImageCompression::lz4Compress(rgb565.data(), rgb565.size());
+    });
+    std::printf("\n");
+  }
+  return 0;
+}
@@ -0,0 +1,223 @@
+// Microbenchmark for the RGB565 pixel kernels in src/pixelkernels.cpp.
+//
+// Cross-checks every ISA path the CPU supports against the scalar reference,
+// then reports throughput for a single 170x320 panel frame (the per-upload
+// case) and for a large batch of frames (converting a whole screen catalog).
+// A second table compares whole-frame conversion with dithering off, Bayer
+// ordered dithering and Floyd-Steinberg.
+
+#include "pixelkernels.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace {
+
+constexpr int kPanelWidth = 170;
+constexpr int kPanelHeight = 320;
+constexpr int kPanelPixels = kPanelWidth * kPanelHeight;
+constexpr int kBatchFrames = 256;
+
+typedef void (*Kernel)(PixelKernels::Isa, const uint8_t *, uint8_t *, int);
+
+struct KernelCase {
+  const char *name;
+  int bytesPerPixel;
+  Kernel kernel;
+};
+
+const KernelCase kCases[] = {
+    {"RGBA8888->RGB565", 4, PixelKernels::rgba8888ToRgb565},
+    {"RGB888->RGB565", 3, PixelKernels::rgb888ToRgb565},
+    {"RGB565 byte swap", 2, PixelKernels::swapRgb565},
+};
+
+const PixelKernels::Isa kIsas[] = {
+    PixelKernels::Isa::Scalar, PixelKernels::Isa::SSE2,
+    PixelKernels::Isa::AVX2, PixelKernels::Isa::NEON};
+
+typedef void (*DitherKernel)(PixelKernels::Isa, const uint8_t *, uint8_t *,
+                             int, int);
+
+struct DitherCase {
+  const char *name;
+  int bytesPerPixel;
+  Kernel plain;
+  DitherKernel ordered;
+};
+
+const DitherCase kDitherCases[] = {
+    {"RGBA8888->RGB565", 4, PixelKernels::rgba8888ToRgb565,
+     PixelKernels::rgba8888ToRgb565Ordered},
+    {"RGB888->RGB565", 3, PixelKernels::rgb888ToRgb565,
+     PixelKernels::rgb888ToRgb565Ordered},
+};
+
+enum class Dither { Off, Ordered, FloydSteinberg };
+
+std::vector<uint8_t> randomBytes(size_t size) {
+  std::mt19937 rng(1234);
+  std::vector<uint8_t> bytes(size);
+  for (uint8_t &b : bytes) {
+    b = static_cast<uint8_t>(rng());
+  }
+  return bytes;
+}
+
+bool crossCheck(const KernelCase &c, PixelKernels::Isa isa) {
+  // Odd lengths exercise the scalar tails behind every vector loop.
+  const int maxPixels = kPanelPixels + 37;
+  const std::vector<uint8_t> src = randomBytes(size_t(maxPixels) * 4);
+  std::vector<uint8_t> expected(size_t(maxPixels) * 2);
+  std::vector<uint8_t> actual(size_t(maxPixels) * 2 + 1);
+
+  for (int pixels = 0; pixels <= maxPixels;
+       pixels += (pixels < 128 ? 1 : 4093)) {
+    c.kernel(PixelKernels::Isa::Scalar, src.data(), expected.data(), pixels);
+    std::memset(actual.data(), 0xa5, actual.size());
+    c.kernel(isa, src.data(), actual.data(), pixels);
+    if (std::memcmp(expected.data(), actual.data(), size_t(pixels) * 2) != 0 ||
+        actual[size_t(pixels) * 2] != 0xa5) {
+      std::printf("MISMATCH %s %s at %d pixels\n", c.name,
+                  PixelKernels::isaName(isa), pixels);
+      return false;
+    }
+  }
+  return true;
+}
+
+double pixelsPerSecond(const KernelCase &c, PixelKernels::Isa isa,
+                       int framePixels, int frames) {
+  const std::vector<uint8_t> src =
+      randomBytes(size_t(framePixels) * frames * c.bytesPerPixel);
+  std::vector<uint8_t> dst(size_t(framePixels) * frames * 2);
+
+  // Repeat until at least ~200 ms have been measured.
+  long long iterations = 0;
+  double seconds = 0.0;
+  const auto start = std::chrono::steady_clock::now();
+  do {
+    for (int f = 0; f < frames; ++f) {
+      c.kernel(isa, src.data() + size_t(f) * framePixels * c.bytesPerPixel,
+               dst.data() + size_t(f) * framePixels * 2, framePixels);
+    }
+    ++iterations;
+    seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                            start)
+                  .count();
+  } while (seconds < 0.2);
+
+  return double(framePixels) * frames * iterations / seconds;
+}
+
+bool crossCheckOrdered(const DitherCase &c, PixelKernels::Isa isa) {
+  const int maxPixels = kPanelWidth + 37;
+  const std::vector<uint8_t> src = randomBytes(size_t(maxPixels) * 4);
+  std::vector<uint8_t> expected(size_t(maxPixels) * 2);
+  std::vector<uint8_t> actual(size_t(maxPixels) * 2 + 1);
+
+  for (int row = 0; row < 4; ++row) {
+    for (int pixels = 0; pixels <= maxPixels; ++pixels) {
+      c.ordered(PixelKernels::Isa::Scalar, src.data(), expected.data(), pixels,
+                row);
+      std::memset(actual.data(), 0xa5, actual.size());
+      c.ordered(isa, src.data(), actual.data(), pixels, row);
+      if (std::memcmp(expected.data(), actual.data(), size_t(pixels) * 2) !=
+              0 ||
+          actual[size_t(pixels) * 2] != 0xa5) {
+        std::printf("MISMATCH %s ordered %s at %d pixels, row %d\n", c.name,
+                    PixelKernels::isaName(isa), pixels, row);
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// Converts whole panel frames row by row, the way LVGLImageConverter does.
+double framesPerSecond(const DitherCase &c, PixelKernels::Isa isa,
+                       Dither dither) {
+  const int srcStride = kPanelWidth * c.bytesPerPixel;
+  const int dstStride = kPanelWidth * 2;
+  const std::vector<uint8_t> src = randomBytes(size_t(srcStride) * kPanelHeight);
+  std::vector<uint8_t> dst(size_t(dstStride) * kPanelHeight);
+
+  long long frames = 0;
+  double seconds = 0.0;
+  const auto start = std::chrono::steady_clock::now();
+  do {
+    if (dither == Dither::FloydSteinberg) {
+      PixelKernels::floydSteinbergToRgb565(src.data(), srcStride,
+                                           c.bytesPerPixel, dst.data(),
+                                           dstStride, kPanelWidth,
+                                           kPanelHeight);
+    } else {
+      for (int y = 0; y < kPanelHeight; ++y) {
+        const uint8_t *in = src.data() + size_t(y) * srcStride;
+        uint8_t *out = dst.data() + size_t(y) * dstStride;
+        if (dither == Dither::Ordered) {
+          c.ordered(isa, in, out, kPanelWidth, y);
+        } else {
+          c.plain(isa, in, out, kPanelWidth);
+        }
+      }
+    }
+    ++frames;
+    seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                            start)
+                  .count();
+  } while (seconds < 0.2);
+
+  return frames / seconds;
+}
+
+} // namespace
+
+int main() {
+  std::printf("Active path: %s\n\n",
+              PixelKernels::isaName(PixelKernels::activeIsa()));
+  std::printf("%-18s %-7s %18s %18s\n", "kernel", "path", "170x320 Mpx/s",
+              "batch Mpx/s");
+
+  bool ok = true;
+  for (const KernelCase &c : kCases) {
+    for (PixelKernels::Isa isa : kIsas) {
+      if (!PixelKernels::isIsaSupported(isa)) {
+        continue;
+      }
+      if (!crossCheck(c, isa)) {
+        ok = false;
+        continue;
+      }
+      const double single = pixelsPerSecond(c, isa, kPanelPixels, 1);
+      const double batch =
+          pixelsPerSecond(c, isa, kPanelPixels, kBatchFrames);
+      std::printf("%-18s %-7s %18.1f %18.1f\n", c.name,
+                  PixelKernels::isaName(isa), single / 1e6, batch / 1e6);
+    }
+  }
+
+  std::printf("\n%-18s %-7s %12s %12s %12s\n", "170x320 frames/s", "path",
+              "no dither", "ordered", "floyd-st.");
+  for (const DitherCase &c : kDitherCases) {
+    for (PixelKernels::Isa isa : kIsas) {
+      if (!PixelKernels::isIsaSupported(isa)) {
+        continue;
+      }
+      if (!crossCheckOrdered(c, isa)) {
+        ok = false;
+        continue;
+      }
+      std::printf("%-18s %-7s %12.0f %12.0f %12.0f\n", c.name,
+                  PixelKernels::isaName(isa),
+                  framesPerSecond(c, isa, Dither::Off),
+                  framesPerSecond(c, isa, Dither::Ordered),
+                  framesPerSecond(c, isa, Dither::FloydSteinberg));
+    }
+  }
+
+  return ok ? 0 : 1;
+}
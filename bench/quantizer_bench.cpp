@@ -0,0 +1,197 @@
+// Quality and speed of the indexed-format quantizer in src/colorquantizer.cpp
+// against the RGB565 path.
+//
+// Uses two synthetic 170x320 panel images: the gradient-and-shapes layout
+// from create_dummy_image.py, and a smooth full-color field standing in for
+// a photo. For each output format it reports the PSNR against the 24-bit
+// source, the time per image and the flash bytes the image would take.
+
+#include "colorquantizer.h"
+#include "pixelkernels.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <random>
+#include <vector>
+
+namespace {
+
+constexpr int kWidth = 170;
+constexpr int kHeight = 320;
+constexpr int kPixels = kWidth * kHeight;
+
+typedef std::vector<uint8_t> Rgba;
+
+void fillRect(Rgba &img, int x0, int y0, int x1, int y1, uint8_t r, uint8_t g,
+              uint8_t b) {
+  for (int y = y0; y <= y1; ++y) {
+    for (int x = x0; x <= x1; ++x) {
+      uint8_t *p = &img[size_t(y * kWidth + x) * 4];
+      p[0] = r;
+      p[1] = g;
+      p[2] = b;
+    }
+  }
+}
+
+// Approximates create_dummy_image.py without the text
+Rgba dummyImage() {
+  Rgba img(size_t(kPixels) * 4, 255);
+  for (int y = 0; y < kHeight; ++y) {
+    const int intensity = int(255 * (1.0 - double(y) / kHeight));
+    fillRect(img, 0, y, kWidth - 1, y, uint8_t(100 + intensity / 3),
+             uint8_t(150 + intensity / 4), uint8_t(200 + intensity / 5));
+  }
+  fillRect(img, 10, 10, kWidth - 11, 12, 0, 0, 139);
+  fillRect(img, 10, 58, kWidth - 11, 60, 0, 0, 139);
+  for (int y = 80; y <= 160; ++y) {
+    for (int x = 20; x <= kWidth - 20; ++x) {
+      const double dx = (x - kWidth / 2.0) / (kWidth / 2.0 - 20);
+      const double dy = (y - 120.0) / 40.0;
+      if (dx * dx + dy * dy <= 1.0) {
+        fillRect(img, x, y, x, y, 255, 255, 255);
+      }
+    }
+  }
+  fillRect(img, 30, 180, kWidth - 31, 220, 144, 238, 144);
+  return img;
+}
+
+Rgba photoImage() {
+  Rgba img(size_t(kPixels) * 4, 255);
+  std::mt19937 rng(42);
+  std::uniform_int_distribution<int> noise(-6, 6);
+  for (int y = 0; y < kHeight; ++y) {
+    for (int x = 0; x < kWidth; ++x) {
+      uint8_t *p = &img[size_t(y * kWidth + x) * 4];
+      const double u = double(x) / kWidth;
+      const double v = double(y) / kHeight;
+      const double r = 128 + 100 * std::sin(6.0 * u + 2.0 * v);
+      const double g = 128 + 100 * std::sin(3.0 * v + 1.0);
+      const double b = 128 + 100 * std::cos(4.0 * u * v + 4.0 * u);
+      p[0] = uint8_t(std::min(255.0, std::max(0.0, r + noise(rng))));
+      p[1] = uint8_t(std::min(255.0, std::max(0.0, g + noise(rng))));
+      p[2] = uint8_t(std::min(255.0, std::max(0.0, b + noise(rng))));
+    }
+  }
+  return img;
+}
+
+double psnr(const Rgba &source, const Rgba &decoded) {
+  double squared = 0.0;
+  for (int i = 0; i < kPixels; ++i) {
+    for (int ch = 0; ch < 3; ++ch) {
+      const double d = double(source[size_t(i) * 4 + ch]) -
+                       double(decoded[size_t(i) * 4 + ch]);
+      squared += d * d;
+    }
+  }
+  const double mse = squared / (kPixels * 3.0);
+  return mse == 0.0 ? 99.0 : 10.0 * std::log10(255.0 * 255.0 / mse);
+}
+
+// Decodes RGB565 the way LVGL does, by bit replication
+Rgba decodeRgb565(const std::vector<uint8_t> &data) {
+  Rgba out(size_t(kPixels) * 4, 255);
+  for (int i = 0; i < kPixels; ++i) {
+    const int c = data[size_t(i) * 2] | data[size_t(i) * 2 + 1] << 8;
+    const int r = c >> 11, g = (c >> 5) & 0x3f, b = c & 0x1f;
+    out[size_t(i) * 4] = uint8_t(r << 3 | r >> 2);
+    out[size_t(i) * 4 + 1] = uint8_t(g << 2 | g >> 4);
+    out[size_t(i) * 4 + 2] = uint8_t(b << 3 | b >> 2);
+  }
+  return out;
+}
+
+double millisecondsPerRun(const std::function<void()> &run) {
+  int runs = 0;
+  double seconds = 0.0;
+  const auto start = std::chrono::steady_clock::now();
+  do {
+    run();
+    ++runs;
+    seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                            start)
+                  .count();
+  } while (seconds < 0.2);
+  return seconds * 1000.0 / runs;
+}
+
+void report(const char *format, double quality, double ms, int bytes) {
+  std::printf("  %-22s %8.2f dB %9.3f ms %9d bytes\n", format, quality, ms,
+              bytes);
+}
+
+void benchRgb565(const Rgba &img, const char *name, int dither) {
+  std::vector<uint8_t> data(size_t(kPixels) * 2);
+  const auto run = [&]() {
+    if (dither == 2) {
+      PixelKernels::floydSteinbergToRgb565(img.data(), kWidth * 4, 4,
+                                           data.data(), kWidth * 2, kWidth,
+                                           kHeight);
+      return;
+    }
+    for (int y = 0; y < kHeight; ++y) {
+      const uint8_t *in = img.data() + size_t(y) * kWidth * 4;
+      uint8_t *out = data.data() + size_t(y) * kWidth * 2;
+      if (dither == 1) {
+        PixelKernels::rgba8888ToRgb565Ordered(in, out, kWidth, y);
+      } else {
+        PixelKernels::rgba8888ToRgb565(in, out, kWidth);
+      }
+    }
+  };
+  const double ms = millisecondsPerRun(run);
+  report(name, psnr(img, decodeRgb565(data)), ms, kPixels * 2);
+}
+
+void benchIndexed(const Rgba &img, int bits, bool dither) {
+  std::vector<ColorQuantizer::Color> palette;
+  std::vector<uint8_t> indices(kPixels);
+  bool exact = false;
+  const auto run = [&]() {
+    palette = ColorQuantizer::buildPalette(img.data(), kWidth, kHeight,
+                                           kWidth * 4, 1 << bits, exact);
+    ColorQuantizer::mapToPalette(img.data(), kWidth, kHeight, kWidth * 4,
+                                 palette, dither, indices.data());
+  };
+  const double ms = millisecondsPerRun(run);
+
+  Rgba decoded(size_t(kPixels) * 4, 255);
+  for (int i = 0; i < kPixels; ++i) {
+    const ColorQuantizer::Color &c = palette[indices[i]];
+    decoded[size_t(i) * 4] = c.r;
+    decoded[size_t(i) * 4 + 1] = c.g;
+    decoded[size_t(i) * 4 + 2] = c.b;
+  }
+
+  char name[32];
+  std::snprintf(name, sizeof(name), "I%d%s", bits, dither ? " + dither" : "");
+  const int stride = (kWidth * bits + 7) / 8;
+  report(name, psnr(img, decoded), ms, (1 << bits) * 4 + stride * kHeight);
+}
+
+} // namespace
+
+int main() {
+  const struct {
+    const char *name;
+    Rgba pixels;
+  } images[] = {{"dummy (gradient + shapes)", dummyImage()},
+                {"photo-like", photoImage()}};
+
+  for (const auto &image : images) {
+    std::printf("%s\n", image.name);
+    benchRgb565(image.pixels, "RGB565", 0);
+    benchRgb565(image.pixels, "RGB565 + ordered", 1);
+    benchRgb565(image.pixels, "RGB565 + floyd-st.", 2);
+    for (int bits : {8, 4, 2}) {
+      benchIndexed(image.pixels, bits, false);
+      benchIndexed(image.pixels, bits, true);
+    }
+    std::printf("\n");
+  }
+  return 0;
+}
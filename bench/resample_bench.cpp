@@ -0,0 +1,147 @@
+// Microbenchmark for the import-stage resampler in src/imageresampler.cpp.
+//
+// Cross-checks the SIMD resampling passes in src/pixelkernels.cpp against
+// the scalar reference, then times fitting typical design exports (a phone
+// screenshot, a 1080p frame, a 4K render and a small icon being upscaled)
+// to the 170x320 panel with each filter.
+
+#include "imageresampler.h"
+#include "pixelkernels.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace {
+
+constexpr int kPanelWidth = 170;
+constexpr int kPanelHeight = 320;
+
+const PixelKernels::Isa kIsas[] = {
+    PixelKernels::Isa::Scalar, PixelKernels::Isa::SSE2,
+    PixelKernels::Isa::AVX2, PixelKernels::Isa::NEON};
+
+const struct {
+  const char *name;
+  ImageResampler::Filter filter;
+} kFilters[] = {{"bicubic", ImageResampler::Filter::Bicubic},
+                {"lanczos3", ImageResampler::Filter::Lanczos3}};
+
+std::vector<uint8_t> randomBytes(size_t size) {
+  std::mt19937 rng(1234);
+  std::vector<uint8_t> bytes(size);
+  for (uint8_t &b : bytes) {
+    b = static_cast<uint8_t>(rng());
+  }
+  return bytes;
+}
+
+// Runs both passes with an explicit path, like ImageResampler::resize()
+void resizeWith(PixelKernels::Isa isa, const std::vector<uint8_t> &src,
+                int srcWidth, int srcHeight, std::vector<uint8_t> &dst,
+                int dstWidth, int dstHeight, ImageResampler::Filter filter) {
+  const ImageResampler::Coefficients h =
+      ImageResampler::coefficients(srcWidth, dstWidth, filter);
+  const ImageResampler::Coefficients v =
+      ImageResampler::coefficients(srcHeight, dstHeight, filter);
+  const int tmpStride = dstWidth * 4;
+  std::vector<uint8_t> tmp(size_t(tmpStride) * srcHeight);
+  for (int y = 0; y < srcHeight; ++y) {
+    PixelKernels::resampleHorizontal(
+        isa, src.data() + size_t(y) * srcWidth * 4,
+        tmp.data() + size_t(y) * tmpStride, dstWidth, h.starts.data(), h.taps,
+        h.weights.data());
+  }
+  dst.assign(size_t(tmpStride) * dstHeight, 0);
+  for (int y = 0; y < dstHeight; ++y) {
+    PixelKernels::resampleVertical(
+        isa, tmp.data() + size_t(v.starts[y]) * tmpStride, tmpStride, v.taps,
+        v.weights.data() + size_t(y) * v.taps,
+        dst.data() + size_t(y) * tmpStride, tmpStride);
+  }
+}
+
+// Odd sizes and both scaling directions exercise the scalar tails, the odd
+// tap counts and windows clamped at the image edges.
+bool crossCheck(PixelKernels::Isa isa) {
+  const int sizes[][4] = {{640, 480, 170, 320}, {37, 91, 170, 320},
+                          {171, 321, 170, 320}, {3, 5, 17, 9},
+                          {1000, 7, 33, 2}};
+  for (const auto &size : sizes) {
+    const std::vector<uint8_t> src =
+        randomBytes(size_t(size[0]) * size[1] * 4);
+    for (const auto &f : kFilters) {
+      std::vector<uint8_t> expected, actual;
+      resizeWith(PixelKernels::Isa::Scalar, src, size[0], size[1], expected,
+                 size[2], size[3], f.filter);
+      resizeWith(isa, src, size[0], size[1], actual, size[2], size[3],
+                 f.filter);
+      if (expected != actual) {
+        std::printf("MISMATCH %s %s at %dx%d -> %dx%d\n", f.name,
+                    PixelKernels::isaName(isa), size[0], size[1], size[2],
+                    size[3]);
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+double millisecondsPerResize(PixelKernels::Isa isa, int srcWidth,
+                             int srcHeight, ImageResampler::Filter filter) {
+  const std::vector<uint8_t> src = randomBytes(size_t(srcWidth) * srcHeight * 4);
+  std::vector<uint8_t> dst;
+  int runs = 0;
+  double seconds = 0.0;
+  const auto start = std::chrono::steady_clock::now();
+  do {
+    resizeWith(isa, src, srcWidth, srcHeight, dst, kPanelWidth, kPanelHeight,
+               filter);
+    ++runs;
+    seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                            start)
+                  .count();
+  } while (seconds < 0.3);
+  return seconds * 1000.0 / runs;
+}
+
+} // namespace
+
+int main() {
+  std::printf("Active path: %s\n\n",
+              PixelKernels::isaName(PixelKernels::activeIsa()));
+
+  for (PixelKernels::Isa isa : kIsas) {
+    if (PixelKernels::isIsaSupported(isa) && !crossCheck(isa)) {
+      return 1;
+    }
+  }
+
+  const struct {
+    const char *name;
+    int width;
+    int height;
+  } sources[] = {{"1080x2400 screenshot", 1080, 2400},
+                 {"1920x1080 frame", 1920, 1080},
+                 {"3840x2160 render", 3840, 2160},
+                 {"48x96 icon (upscale)", 48, 96}};
+
+  std::printf("%-22s %-9s %-7s %12s\n", "source -> 170x320", "filter", "path",
+              "ms/image");
+  for (const auto &source : sources) {
+    for (const auto &f : kFilters) {
+      for (PixelKernels::Isa isa : kIsas) {
+        if (!PixelKernels::isIsaSupported(isa)) {
+          continue;
+        }
+        std::printf("%-22s %-9s %-7s %12.3f\n", source.name, f.name,
+                    PixelKernels::isaName(isa),
+                    millisecondsPerResize(isa, source.width, source.height,
+                                          f.filter));
+      }
+    }
+  }
+  return 0;
+}
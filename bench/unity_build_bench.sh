@@ -0,0 +1,72 @@
+#!/bin/bash
+# Clean firmware build time with and without the unity build of LVGL and the
+# nRF5 SDK (nrf52_configure_scripts/unity_build.cmake).
+#
+# Usage: bench/unity_build_bench.sh <build_mcu> [units ...]
+#
+# Runs `configure.sh <type> clean` in the app's build_mcu directory once with
+# every source compiled on its own and once per unity setting (default 4, 8
+# and 16 units per library), RUNS times each (default 3). The compiler cache
+# and the prebuilt archives are off, so every source is compiled every time.
+# Prints the median wall time and the number of build steps of each mode.
+# BUILD_TYPE (default Debug) and LCD_BUILD_JOBS/LCD_BUILD_LOAD are passed
+# through. The next upload from the app reconfigures the directory with its
+# own settings.
+
+set -e
+
+BUILD_DIR="$1"
+if [ -z "$BUILD_DIR" ] || [ ! -f "$BUILD_DIR/configure.sh" ]; then
+    echo "Usage: $0 <build_mcu directory with configure.sh> [units ...]" >&2
+    exit 1
+fi
+shift
+UNITS=("$@")
+if [ ${#UNITS[@]} -eq 0 ]; then
+    UNITS=(4 8 16)
+fi
+RUNS="${RUNS:-3}"
+BUILD_TYPE="${BUILD_TYPE:-Debug}"
+
+cd "$BUILD_DIR"
+
+now_ms() {
+    echo $(($(date +%s%N) / 1000000))
+}
+
+# Median of the arguments
+median() {
+    printf '%s\n' "$@" | sort -n | awk '{ v[NR] = $1 } END { print v[int((NR + 1) / 2)] }'
+}
+
+run_mode() {
+    local units="$1"
+    local times=()
+    local steps=0
+    for ((run = 1; run <= RUNS; run++)); do
+        local log="unity_bench_${units}_${run}.log"
+        local start
+        start=$(now_ms)
+        if ! env -u LCD_COMPILER_LAUNCHER CCACHE_DISABLE=1 \
+            LCD_PREBUILT_LIBRARIES=0 LCD_UNITY_BUILD="$units" LCD_TIME_REPORT=0 \
+            bash configure.sh "$BUILD_TYPE" clean > "$log" 2>&1; then
+            echo "Build with LCD_UNITY_BUILD=$units failed, see $BUILD_DIR/$log" >&2
+            return 1
+        fi
+        times+=($(($(now_ms) - start)))
+        steps=$(grep -vc '^#' .ninja_log 2>/dev/null || true)
+        rm -f "$log"
+    done
+    local label="$units"
+    if [ "$units" = "0" ]; then
+        label="off"
+    fi
+    printf '%-10s %12s %8s   %s\n' "$label" "$(median "${times[@]}")" "$steps" "${times[*]}"
+}
+
+echo "Clean $BUILD_TYPE builds, $RUNS runs each, jobs ${LCD_BUILD_JOBS:-ninja default}"
+printf '%-10s %12s %8s   %s\n' "units" "median (ms)" "steps" "all runs (ms)"
+run_mode 0
+for units in "${UNITS[@]}"; do
+    run_mode "$units"
+done
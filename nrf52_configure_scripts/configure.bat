@@ -60,9 +60,11 @@ if errorlevel 1 (
 set "SOURCE_PATH=%CD%"
 popd
 
-REM Set build type (default to Debug if not specified)
+REM Set build type (the app's firmware profile in LCD_BUILD_TYPE, else Debug)
 set "BUILD_TYPE=%~1"
+if "%BUILD_TYPE%"=="" set "BUILD_TYPE=%LCD_BUILD_TYPE%"
 if "%BUILD_TYPE%"=="" set "BUILD_TYPE=Debug"
+set "CLEAN=%~2"
 
 REM Convert images path to absolute path
 pushd "%SCRIPT_DIR%\..\generated" 2>nul
@@ -84,16 +86,134 @@ echo   NINJA:         %NINJA_PATH%
 echo   SOURCE:        %SOURCE_PATH%
 echo.
 
-REM Always clean CMake cache to ensure fresh configuration
-echo Cleaning previous build files...
-if exist CMakeCache.txt del /F /Q CMakeCache.txt
-if exist CMakeFiles rd /S /Q CMakeFiles
-if exist cmake_install.cmake del /F /Q cmake_install.cmake
-if exist Makefile del /F /Q Makefile
-
 REM Change to script directory
 cd /d "%SCRIPT_DIR%"
 
+REM LVGL and SDK archives shared by all builds with the same configuration
+REM (see prebuilt_libraries.cmake); LCD_PREBUILT_LIBRARIES=0 turns them off
+set "PREBUILT_PATH="
+if not "%LCD_PREBUILT_LIBRARIES%"=="0" (
+    if not exist "%SCRIPT_DIR%\..\libraries\prebuilt" mkdir "%SCRIPT_DIR%\..\libraries\prebuilt"
+    pushd "%SCRIPT_DIR%\..\libraries\prebuilt"
+    set "PREBUILT_PATH=!CD!"
+    popd
+)
+
+REM Link-time optimization in the Release and MinSizeRel builds (see
+REM toolchain-arm-none-eabi.cmake); off unless LCD_FIRMWARE_LTO=1
+set "FIRMWARE_LTO=OFF"
+if "%LCD_FIRMWARE_LTO%"=="1" set "FIRMWARE_LTO=ON"
+
+REM -ftime-report on every compile, for the app's build profile
+set "TIME_REPORT=OFF"
+if "%LCD_TIME_REPORT%"=="1" set "TIME_REPORT=ON"
+
+REM Unity translation units per library for LVGL and the SDK, 0 for none
+REM (see unity_build.cmake)
+set "UNITY_BUILD=0"
+if defined LCD_UNITY_BUILD set /a "UNITY_BUILD=LCD_UNITY_BUILD" 2>nul
+if !UNITY_BUILD! LSS 0 set "UNITY_BUILD=0"
+
+REM Everything that needs a fresh configure when it changes. Bump
+REM STAMP_VERSION whenever the cmake command line below changes.
+set "STAMP_VERSION=7"
+set "STAMP_FILE=configure.stamp"
+set "SOURCES_FILE=generated_sources.stamp"
+
+set "GCC_VERSION=unknown"
+for /f "delims=" %%v in ('call "%ARM_GCC_PATH%\bin\arm-none-eabi-gcc.exe" -dumpversion 2^>nul') do set "GCC_VERSION=%%v"
+set "SDK_VERSION=unknown"
+if exist "%NRF_SDK_PATH%\documentation\release_notes.txt" (
+    set /p SDK_VERSION=<"%NRF_SDK_PATH%\documentation\release_notes.txt"
+)
+set "LVGL_VERSION="
+if exist "%LVGL_PATH%\lv_version.h" (
+    for /f "tokens=2,3" %%a in ('findstr /C:"#define LVGL_VERSION_MAJOR " /C:"#define LVGL_VERSION_MINOR " /C:"#define LVGL_VERSION_PATCH " "%LVGL_PATH%\lv_version.h"') do (
+        if defined LVGL_VERSION (set "LVGL_VERSION=!LVGL_VERSION!.%%b") else (set "LVGL_VERSION=%%b")
+    )
+)
+if not defined LVGL_VERSION set "LVGL_VERSION=unknown"
+set "FIRMWARE_TAG=untagged"
+for /f "delims=" %%t in ('git -C "%SOURCE_PATH%" describe --tags --always 2^>nul') do set "FIRMWARE_TAG=%%t"
+
+REM One line at a time: a block would break on paths like "Program Files (x86)"
+> "%STAMP_FILE%.new" echo stamp=%STAMP_VERSION%
+>> "%STAMP_FILE%.new" echo generator=Ninja
+>> "%STAMP_FILE%.new" echo toolchain=!ARM_GCC_PATH! gcc !GCC_VERSION!
+>> "%STAMP_FILE%.new" echo sdk=!NRF_SDK_PATH! !SDK_VERSION!
+>> "%STAMP_FILE%.new" echo lvgl=!LVGL_PATH! !LVGL_VERSION!
+>> "%STAMP_FILE%.new" echo firmware=!SOURCE_PATH! !FIRMWARE_TAG!
+>> "%STAMP_FILE%.new" echo images=!IMAGES_PATH!
+if defined LCD_COMPILER_LAUNCHER (
+    >> "%STAMP_FILE%.new" echo launcher=!LCD_COMPILER_LAUNCHER!
+) else (
+    >> "%STAMP_FILE%.new" echo launcher=none
+)
+if defined PREBUILT_PATH (
+    >> "%STAMP_FILE%.new" echo prebuilt=!PREBUILT_PATH!
+) else (
+    >> "%STAMP_FILE%.new" echo prebuilt=none
+)
+>> "%STAMP_FILE%.new" echo time_report=!TIME_REPORT!
+>> "%STAMP_FILE%.new" echo unity=!UNITY_BUILD!
+>> "%STAMP_FILE%.new" echo lto=!FIRMWARE_LTO!
+>> "%STAMP_FILE%.new" echo build_type=!BUILD_TYPE!
+
+REM The firmware picks up the generated sources with a glob at configure time,
+REM and firmware_hooks.cmake links the blob object only if it existed then, so
+REM images added or removed since then need a configure run as well.
+dir /B /ON "%IMAGES_PATH%\*.c" "%IMAGES_PATH%\*.o" > "%SOURCES_FILE%.new" 2>nul
+
+REM With LCD_RELINK_ONLY=1 the app expects only the image data to have
+REM changed. Build in place if nothing a configure depends on changed either,
+REM and otherwise exit with 3 before touching anything; the app then runs the
+REM full configure and build.
+if "%LCD_RELINK_ONLY%"=="1" (
+    set "RELINK_OK=1"
+    if not exist CMakeCache.txt set "RELINK_OK=0"
+    if not exist build.ninja set "RELINK_OK=0"
+    fc /B "%STAMP_FILE%" "%STAMP_FILE%.new" >nul 2>&1
+    if errorlevel 1 set "RELINK_OK=0"
+    fc /B "%SOURCES_FILE%" "%SOURCES_FILE%.new" >nul 2>&1
+    if errorlevel 1 set "RELINK_OK=0"
+    if "!RELINK_OK!"=="0" (
+        echo Configuration changed, a full build is needed
+        del /F /Q "%STAMP_FILE%.new" "%SOURCES_FILE%.new"
+        exit /b 3
+    )
+)
+
+REM Reconfigure only when asked to or when the stamp no longer matches; the
+REM build directory is otherwise kept, so ninja only recompiles what changed.
+set "RECONFIGURE=0"
+if /I "%CLEAN%"=="clean" (
+    call :clean_build_files
+    set "RECONFIGURE=1"
+) else if not exist CMakeCache.txt (
+    set "RECONFIGURE=1"
+) else if not exist build.ninja (
+    set "RECONFIGURE=1"
+) else if not exist "%STAMP_FILE%" (
+    set "RECONFIGURE=1"
+) else (
+    fc /B "%STAMP_FILE%" "%STAMP_FILE%.new" >nul 2>&1
+    if errorlevel 1 (
+        echo Toolchain, library versions or build type changed
+        call :clean_build_files
+        set "RECONFIGURE=1"
+    )
+)
+
+REM A changed set of generated sources reconfigures in place; the cache and
+REM the compiled objects are kept
+if "%RECONFIGURE%"=="0" (
+    fc /B "%SOURCES_FILE%" "%SOURCES_FILE%.new" >nul 2>&1
+    if errorlevel 1 (
+        echo Generated sources added or removed, refreshing the configuration
+        set "RECONFIGURE=1"
+    )
+)
+
 REM Add Ninja to PATH
 for %%i in ("%NINJA_PATH%") do set "NINJA_DIR=%%~dpi"
 set "NINJA_DIR=%NINJA_DIR:~0,-1%"
@@ -110,6 +230,27 @@ REM Use toolchain file to set compilers (must be before source directory)
 set "TOOLCHAIN_FILE=%SCRIPT_DIR%\toolchain-arm-none-eabi.cmake"
 set "TOOLCHAIN_FILE=%TOOLCHAIN_FILE:\=/%"
 
+REM Links the image blob object and the prebuilt archives, sets up the unity
+REM build and adds -ftime-report (see firmware_hooks.cmake)
+set HOOK_ARGS=-DCMAKE_PROJECT_INCLUDE:FILEPATH="%SCRIPT_DIR:\=/%/firmware_hooks.cmake" -DLCD_UNITY_BUILD:STRING=%UNITY_BUILD% -DLCD_TIME_REPORT:BOOL=%TIME_REPORT%
+if defined PREBUILT_PATH (
+    set "PREBUILT_PATH=!PREBUILT_PATH:\=/!"
+    set HOOK_ARGS=!HOOK_ARGS! -DLCD_PREBUILT_DIR:STRING="!PREBUILT_PATH!"
+)
+
+REM Compiler cache (ccache) set up by the app, if one was found
+set "LAUNCHER_ARGS="
+if defined LCD_COMPILER_LAUNCHER (
+    echo Compiler cache: !LCD_COMPILER_LAUNCHER! ^(!CCACHE_DIR!^)
+    set LAUNCHER_ARGS=-DCMAKE_C_COMPILER_LAUNCHER:STRING="!LCD_COMPILER_LAUNCHER!" -DCMAKE_CXX_COMPILER_LAUNCHER:STRING="!LCD_COMPILER_LAUNCHER!"
+)
+
+if "%RECONFIGURE%"=="0" (
+    echo Configuration unchanged, building incrementally
+    del /F /Q "%STAMP_FILE%.new" "%SOURCES_FILE%.new"
+    goto build
+)
+
 "%CMAKE_PATH%" ^
     -G "Ninja" ^
     -DCMAKE_TOOLCHAIN_FILE="%TOOLCHAIN_FILE%" ^
@@ -118,14 +259,44 @@ set "TOOLCHAIN_FILE=%TOOLCHAIN_FILE:\=/%"
     -DLVGL_PATH:STRING="%LVGL_PATH%" ^
     -DIMAGES_PATH:STRING="%IMAGES_PATH%" ^
     -DCMAKE_BUILD_TYPE="%BUILD_TYPE%" ^
+    -DLCD_FIRMWARE_LTO:BOOL=%FIRMWARE_LTO% ^
+    %LAUNCHER_ARGS% ^
+    %HOOK_ARGS% ^
     "%SOURCE_PATH%"
 
 if errorlevel 1 (
     echo.
     echo Configuration failed!
+    del /F /Q "%STAMP_FILE%.new" "%SOURCES_FILE%.new"
     exit /b 1
 )
 
-"%CMAKE_PATH%" --build .
+REM Written only after a successful configure, so a failed one is retried
+move /Y "%STAMP_FILE%.new" "%STAMP_FILE%" >nul
+move /Y "%SOURCES_FILE%.new" "%SOURCES_FILE%" >nul
+
+:build
+REM Job count and load limit picked by the app from the cores and free memory
+set "BUILD_ARGS="
+if defined LCD_BUILD_JOBS (
+    echo Build jobs: !LCD_BUILD_JOBS!, load limit !LCD_BUILD_LOAD!
+    set "BUILD_ARGS=-- -j !LCD_BUILD_JOBS!"
+    if defined LCD_BUILD_LOAD set "BUILD_ARGS=!BUILD_ARGS! -l !LCD_BUILD_LOAD!"
+)
+"%CMAKE_PATH%" --build . %BUILD_ARGS%
+set "BUILD_RESULT=%ERRORLEVEL%"
 
-endlocal
+endlocal & exit /b %BUILD_RESULT%
+
+:clean_build_files
+echo Cleaning previous build files...
+if exist CMakeCache.txt del /F /Q CMakeCache.txt
+if exist CMakeFiles rd /S /Q CMakeFiles
+if exist cmake_install.cmake del /F /Q cmake_install.cmake
+if exist Makefile del /F /Q Makefile
+if exist build.ninja del /F /Q build.ninja
+if exist .ninja_deps del /F /Q .ninja_deps
+if exist .ninja_log del /F /Q .ninja_log
+if exist "%STAMP_FILE%" del /F /Q "%STAMP_FILE%"
+if exist "%SOURCES_FILE%" del /F /Q "%SOURCES_FILE%"
+exit /b 0
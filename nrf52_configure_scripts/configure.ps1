@@ -2,10 +2,14 @@
 # configure.ps1 - PowerShell CMake configuration script for Windows/Linux/macOS
 
 param(
-    [string]$BuildType = "Debug",
+    [string]$BuildType = "",
     [switch]$Clean
 )
 
+# The app's firmware profile in LCD_BUILD_TYPE, else Debug
+if (-not $BuildType) { $BuildType = $env:LCD_BUILD_TYPE }
+if (-not $BuildType) { $BuildType = "Debug" }
+
 # Stop on errors
 $ErrorActionPreference = "Stop"
 
@@ -63,13 +67,6 @@ try {
     Push-Location $ScriptDir
 
     try {
-        # Always clean CMake cache to ensure fresh configuration
-        Write-Host "Cleaning previous build files..." -ForegroundColor Yellow
-        if (Test-Path "CMakeCache.txt") { Remove-Item "CMakeCache.txt" -Force }
-        if (Test-Path "CMakeFiles") { Remove-Item "CMakeFiles" -Recurse -Force }
-        if (Test-Path "cmake_install.cmake") { Remove-Item "cmake_install.cmake" -Force }
-        if (Test-Path "Makefile") { Remove-Item "Makefile" -Force }
-
         # Convert paths to use forward slashes for CMake compatibility
         $ArmGccPath = $ArmGccPath -replace '\\', '/'
         $NrfSdkPath = $NrfSdkPath -replace '\\', '/'
@@ -81,6 +78,10 @@ try {
         $ToolchainFile = Join-Path $ScriptDir "toolchain-arm-none-eabi.cmake"
         $ToolchainFile = $ToolchainFile -replace '\\', '/'
 
+        # Link-time optimization in the Release and MinSizeRel builds (see
+        # toolchain-arm-none-eabi.cmake); off unless LCD_FIRMWARE_LTO=1
+        $FirmwareLto = if ($env:LCD_FIRMWARE_LTO -eq "1") { "ON" } else { "OFF" }
+
         # Build CMake arguments (use STRING type for cache variables)
         $CmakeArgs = @(
             "-DCMAKE_TOOLCHAIN_FILE=$ToolchainFile",
@@ -89,26 +90,178 @@ try {
             "-DLVGL_PATH:STRING=$LvglPath",
             "-DIMAGES_PATH:STRING=$ImagesPath",
             "-DCMAKE_BUILD_TYPE=$BuildType",
+            "-DLCD_FIRMWARE_LTO:BOOL=$FirmwareLto",
             "$SourcePath"
         )
 
+        # LVGL and SDK archives shared by all builds with the same
+        # configuration (see prebuilt_libraries.cmake);
+        # LCD_PREBUILT_LIBRARIES=0 turns them off
+        # firmware_hooks.cmake also links the image blob object
+        $HooksInclude = (Join-Path $ScriptDir "firmware_hooks.cmake") -replace '\\', '/'
+        $CmakeArgs = @("-DCMAKE_PROJECT_INCLUDE:FILEPATH=$HooksInclude") + $CmakeArgs
+        $PrebuiltPath = "none"
+        if ($env:LCD_PREBUILT_LIBRARIES -ne "0") {
+            $PrebuiltDir = Join-Path $ScriptDir "../libraries/prebuilt"
+            New-Item -ItemType Directory -Force -Path $PrebuiltDir | Out-Null
+            $PrebuiltPath = (Resolve-Path $PrebuiltDir).Path -replace '\\', '/'
+            $CmakeArgs = @("-DLCD_PREBUILT_DIR:STRING=$PrebuiltPath") + $CmakeArgs
+        }
+
+        # Unity translation units per library for LVGL and the SDK, 0 for
+        # none (see unity_build.cmake)
+        $UnityBuild = 0
+        if (-not [int]::TryParse("$env:LCD_UNITY_BUILD", [ref]$UnityBuild) -or $UnityBuild -lt 0) {
+            $UnityBuild = 0
+        }
+        $CmakeArgs = @("-DLCD_UNITY_BUILD:STRING=$UnityBuild") + $CmakeArgs
+
+        # -ftime-report on every compile, for the app's build profile
+        $TimeReport = if ($env:LCD_TIME_REPORT -eq "1") { "ON" } else { "OFF" }
+        $CmakeArgs = @("-DLCD_TIME_REPORT:BOOL=$TimeReport") + $CmakeArgs
+
+        # Compiler cache (ccache) set up by the app, if one was found
+        $Launcher = $env:LCD_COMPILER_LAUNCHER
+        if ($Launcher) {
+            Write-Host "Compiler cache: $Launcher ($env:CCACHE_DIR)" -ForegroundColor Cyan
+            $CmakeArgs = @(
+                "-DCMAKE_C_COMPILER_LAUNCHER:STRING=$Launcher",
+                "-DCMAKE_CXX_COMPILER_LAUNCHER:STRING=$Launcher"
+            ) + $CmakeArgs
+        } else {
+            $Launcher = "none"
+        }
+
         # Add generator for Windows
+        $Generator = "default"
         if ($IsWindows -or $env:OS -match "Windows") {
-            $CmakeArgs = @("-G", "MinGW Makefiles") + $CmakeArgs
+            $Generator = "MinGW Makefiles"
+            $CmakeArgs = @("-G", $Generator) + $CmakeArgs
         }
 
-        # Run CMake
-        Write-Host "Running CMake..." -ForegroundColor Cyan
-        & $CmakeExe @CmakeArgs
+        # Everything that needs a fresh configure when it changes. Bump
+        # $StampVersion whenever the CMake arguments above change.
+        $StampVersion = 7
+        $StampFile = "configure.stamp"
+        $SourcesFile = "generated_sources.stamp"
 
-        if ($LASTEXITCODE -ne 0) {
-            throw "CMake configuration failed with exit code $LASTEXITCODE"
+        $GccVersion = "unknown"
+        $GccExe = Get-ChildItem (Join-Path $ArmGccPath "bin") -Filter "arm-none-eabi-gcc*" -ErrorAction SilentlyContinue |
+            Where-Object { $_.BaseName -eq "arm-none-eabi-gcc" } | Select-Object -First 1
+        if ($GccExe) { $GccVersion = (& $GccExe.FullName -dumpversion) }
+
+        $SdkVersion = "unknown"
+        $ReleaseNotes = Join-Path $NrfSdkPath "documentation/release_notes.txt"
+        if (Test-Path $ReleaseNotes) { $SdkVersion = Get-Content $ReleaseNotes -TotalCount 1 }
+
+        $LvglVersion = "unknown"
+        $VersionHeader = Join-Path $LvglPath "lv_version.h"
+        if (Test-Path $VersionHeader) {
+            $Parts = Select-String -Path $VersionHeader -Pattern '#define LVGL_VERSION_(MAJOR|MINOR|PATCH)\s+(\d+)' |
+                ForEach-Object { $_.Matches[0].Groups[2].Value }
+            if ($Parts) { $LvglVersion = $Parts -join "." }
+        }
+
+        $FirmwareTag = "untagged"
+        if (Get-Command git -ErrorAction SilentlyContinue) {
+            $Tag = & git -C $SourcePath describe --tags --always 2>$null
+            if ($LASTEXITCODE -eq 0 -and $Tag) { $FirmwareTag = $Tag }
+        }
+
+        $Stamp = @(
+            "stamp=$StampVersion",
+            "generator=$Generator",
+            "toolchain=$ArmGccPath gcc $GccVersion",
+            "sdk=$NrfSdkPath $SdkVersion",
+            "lvgl=$LvglPath $LvglVersion",
+            "firmware=$SourcePath $FirmwareTag",
+            "images=$ImagesPath",
+            "launcher=$Launcher",
+            "prebuilt=$PrebuiltPath",
+            "time_report=$TimeReport",
+            "unity=$UnityBuild",
+            "lto=$FirmwareLto",
+            "build_type=$BuildType"
+        ) -join "`n"
+
+        # The firmware picks up the generated sources with a glob at configure
+        # time, and firmware_hooks.cmake links the blob object only if it
+        # existed then, so images added or removed since then need a configure
+        # run as well.
+        $GeneratedSources = (Get-ChildItem -Path (Join-Path $ImagesPath "*") -Include "*.c", "*.o" -File |
+            ForEach-Object { $_.Name } | Sort-Object) -join "`n"
+
+        # With LCD_RELINK_ONLY=1 the app expects only the image data to have
+        # changed. Build in place if nothing a configure depends on changed
+        # either, and otherwise exit with 3 before touching anything; the app
+        # then runs the full configure and build.
+        if ($env:LCD_RELINK_ONLY -eq "1") {
+            $Current = { param($Path) if (Test-Path $Path) { (Get-Content $Path -Raw).TrimEnd() } }
+            if (-not (Test-Path "CMakeCache.txt") -or -not (Test-Path "build.ninja") -or
+                    ((& $Current $StampFile) -ne $Stamp) -or
+                    ((& $Current $SourcesFile) -ne $GeneratedSources)) {
+                Write-Host "Configuration changed, a full build is needed" -ForegroundColor Yellow
+                exit 3
+            }
+        }
+
+        # Reconfigure only when asked to or when the stamp no longer matches;
+        # the build directory is otherwise kept, so only changed sources are
+        # recompiled.
+        $Reconfigure = $Clean -or -not (Test-Path "CMakeCache.txt") -or -not (Test-Path $StampFile)
+        if (-not $Reconfigure -and ((Get-Content $StampFile -Raw).TrimEnd() -ne $Stamp)) {
+            Write-Host "Toolchain, library versions or build type changed" -ForegroundColor Yellow
+            $Reconfigure = $true
+        }
+
+        if ($Reconfigure) {
+            Write-Host "Cleaning previous build files..." -ForegroundColor Yellow
+            foreach ($Item in @("CMakeCache.txt", "CMakeFiles", "cmake_install.cmake", "Makefile",
+                                "build.ninja", ".ninja_deps", ".ninja_log", $StampFile, $SourcesFile)) {
+                if (Test-Path $Item) { Remove-Item $Item -Recurse -Force }
+            }
+        }
+
+        # A changed set of generated sources reconfigures in place; the cache
+        # and the compiled objects are kept
+        $Configured = $Reconfigure
+        if (-not $Reconfigure -and (-not (Test-Path $SourcesFile) -or
+                ((Get-Content $SourcesFile -Raw).TrimEnd() -ne $GeneratedSources))) {
+            Write-Host "Generated sources added or removed, refreshing the configuration" -ForegroundColor Yellow
+            $Configured = $true
+        }
+
+        if ($Configured) {
+
+            # Run CMake
+            Write-Host "Running CMake..." -ForegroundColor Cyan
+            & $CmakeExe @CmakeArgs
+
+            if ($LASTEXITCODE -ne 0) {
+                throw "CMake configuration failed with exit code $LASTEXITCODE"
+            }
+
+            # Written only after a successful configure, so a failed one is retried
+            Set-Content -Path $StampFile -Value $Stamp
+            Set-Content -Path $SourcesFile -Value $GeneratedSources
+        } else {
+            Write-Host "Configuration unchanged, building incrementally" -ForegroundColor Green
         }
 
         # Build the project
         Write-Host ""
         Write-Host "Building project..." -ForegroundColor Cyan
-        & $CmakeExe --build .
+        # Job count and load limit picked by the app from the cores and free
+        # memory; both Ninja and make take -j and -l
+        $BuildArgs = @("--build", ".")
+        if ($env:LCD_BUILD_JOBS) {
+            Write-Host "Build jobs: $env:LCD_BUILD_JOBS, load limit $env:LCD_BUILD_LOAD" -ForegroundColor Cyan
+            $BuildArgs += @("--", "-j", $env:LCD_BUILD_JOBS)
+            if ($env:LCD_BUILD_LOAD) {
+                $BuildArgs += @("-l", $env:LCD_BUILD_LOAD)
+            }
+        }
+        & $CmakeExe @BuildArgs
 
         if ($LASTEXITCODE -ne 0) {
             throw "Build failed with exit code $LASTEXITCODE"
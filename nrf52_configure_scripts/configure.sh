@@ -43,8 +43,9 @@ SOURCE_PATH="$(cd "$SCRIPT_DIR/../libraries/nrf52-lcd-tester-fw" 2>/dev/null &&
     exit 1
 }
 
-# Set build type (default to Debug if not specified)
-BUILD_TYPE="${1:-Debug}"
+# Set build type (the app's firmware profile in LCD_BUILD_TYPE, else Debug)
+BUILD_TYPE="${1:-${LCD_BUILD_TYPE:-Debug}}"
+CLEAN="$2"
 
 # Convert images path to absolute path
 IMAGES_PATH="$(cd "$SCRIPT_DIR/../generated" 2>/dev/null && pwd)" || {
@@ -63,10 +64,103 @@ echo "  NINJA:         $NINJA_PATH/ninja"
 echo "  SOURCE:        $SOURCE_PATH"
 echo ""
 
-# Always clean previous build files to ensure fresh configuration
-echo "Cleaning previous build files..."
-rm -f CMakeCache.txt cmake_install.cmake Makefile
-rm -rf CMakeFiles/
+# LVGL and SDK archives shared by all builds with the same configuration
+# (see prebuilt_libraries.cmake); LCD_PREBUILT_LIBRARIES=0 turns them off
+PREBUILT_PATH=""
+if [ "${LCD_PREBUILT_LIBRARIES:-1}" != "0" ]; then
+    mkdir -p "$SCRIPT_DIR/../libraries/prebuilt"
+    PREBUILT_PATH="$(cd "$SCRIPT_DIR/../libraries/prebuilt" && pwd)"
+fi
+
+# Link-time optimization in the Release and MinSizeRel builds (see
+# toolchain-arm-none-eabi.cmake); off unless LCD_FIRMWARE_LTO=1
+FIRMWARE_LTO=OFF
+if [ "$LCD_FIRMWARE_LTO" = "1" ]; then
+    FIRMWARE_LTO=ON
+fi
+
+# -ftime-report on every compile, for the app's build profile
+TIME_REPORT=OFF
+if [ "${LCD_TIME_REPORT:-0}" = "1" ]; then
+    TIME_REPORT=ON
+fi
+
+# Unity translation units per library for LVGL and the SDK, 0 for none
+# (see unity_build.cmake)
+UNITY_BUILD="${LCD_UNITY_BUILD:-0}"
+case "$UNITY_BUILD" in
+    ''|*[!0-9]*) UNITY_BUILD=0 ;;
+esac
+
+# Everything that needs a fresh configure when it changes. Bump
+# STAMP_VERSION whenever the cmake command line below changes.
+STAMP_VERSION=7
+STAMP_FILE="configure.stamp"
+SOURCES_FILE="generated_sources.stamp"
+
+GCC_VERSION="$("$ARM_GCC_PATH/bin/arm-none-eabi-gcc" -dumpversion 2>/dev/null || echo unknown)"
+SDK_VERSION="$(head -n 1 "$NRF_SDK_PATH/documentation/release_notes.txt" 2>/dev/null || echo unknown)"
+LVGL_VERSION="$(awk '/#define LVGL_VERSION_(MAJOR|MINOR|PATCH)[ \t]/ { v = v (v ? "." : "") $3 } END { print v }' "$LVGL_PATH/lv_version.h" 2>/dev/null || true)"
+FIRMWARE_TAG="$(git -C "$SOURCE_PATH" describe --tags --always 2>/dev/null || echo untagged)"
+
+STAMP="stamp=$STAMP_VERSION
+generator=Ninja
+toolchain=$ARM_GCC_PATH gcc $GCC_VERSION
+sdk=$NRF_SDK_PATH $SDK_VERSION
+lvgl=$LVGL_PATH ${LVGL_VERSION:-unknown}
+firmware=$SOURCE_PATH $FIRMWARE_TAG
+images=$IMAGES_PATH
+launcher=${LCD_COMPILER_LAUNCHER:-none}
+prebuilt=${PREBUILT_PATH:-none}
+time_report=$TIME_REPORT
+unity=$UNITY_BUILD
+lto=$FIRMWARE_LTO
+build_type=$BUILD_TYPE"
+
+clean_build_files() {
+    echo "Cleaning previous build files..."
+    rm -rf CMakeCache.txt cmake_install.cmake Makefile build.ninja .ninja_deps .ninja_log CMakeFiles/ "$STAMP_FILE" "$SOURCES_FILE"
+}
+
+# The firmware picks up the generated sources with a glob at configure time,
+# and firmware_hooks.cmake links the blob object only if it existed then, so
+# images added or removed since then need a configure run as well.
+GENERATED_SOURCES="$(cd "$IMAGES_PATH" && LC_ALL=C ls -1 -- *.c *.o 2>/dev/null || true)"
+
+# With LCD_RELINK_ONLY=1 the app expects only the image data to have
+# changed. Build in place if nothing a configure depends on changed either,
+# and otherwise exit with 3 before touching anything; the app then runs the
+# full configure and build.
+if [ "$LCD_RELINK_ONLY" = "1" ]; then
+    if [ ! -f CMakeCache.txt ] || [ ! -f build.ninja ] \
+        || [ "$(cat "$STAMP_FILE" 2>/dev/null)" != "$STAMP" ] \
+        || [ "$(cat "$SOURCES_FILE" 2>/dev/null)" != "$GENERATED_SOURCES" ]; then
+        echo "Configuration changed, a full build is needed"
+        exit 3
+    fi
+fi
+
+# Reconfigure only when asked to or when the stamp no longer matches; the
+# build directory is otherwise kept, so ninja only recompiles what changed.
+RECONFIGURE=0
+if [ "$CLEAN" = "clean" ]; then
+    clean_build_files
+    RECONFIGURE=1
+elif [ ! -f CMakeCache.txt ] || [ ! -f build.ninja ] || [ ! -f "$STAMP_FILE" ]; then
+    RECONFIGURE=1
+elif [ "$(cat "$STAMP_FILE")" != "$STAMP" ]; then
+    echo "Toolchain, library versions or build type changed:"
+    diff "$STAMP_FILE" - <<< "$STAMP" || true
+    clean_build_files
+    RECONFIGURE=1
+fi
+
+# A changed set of generated sources reconfigures in place; the cache and
+# the compiled objects are kept
+if [ "$RECONFIGURE" = "0" ] && [ "$(cat "$SOURCES_FILE" 2>/dev/null)" != "$GENERATED_SOURCES" ]; then
+    echo "Generated sources added or removed, refreshing the configuration"
+    RECONFIGURE=1
+fi
 
 # Add Ninja to PATH
 export PATH="$NINJA_PATH:$PATH"
@@ -80,21 +174,61 @@ export IMAGES_PATH
 # Set toolchain file path
 TOOLCHAIN_FILE="$SCRIPT_DIR/toolchain-arm-none-eabi.cmake"
 
-# Run CMake with absolute paths and Ninja generator
-"$CMAKE_PATH/cmake" \
-    -G "Ninja" \
-    -DCMAKE_TOOLCHAIN_FILE="$TOOLCHAIN_FILE" \
-    -DARM_GCC_PATH:STRING="$ARM_GCC_PATH" \
-    -DNRF_SDK_PATH:STRING="$NRF_SDK_PATH" \
-    -DLVGL_PATH:STRING="$LVGL_PATH" \
-    -DIMAGES_PATH:STRING="$IMAGES_PATH" \
-    -DCMAKE_BUILD_TYPE="$BUILD_TYPE" \
-    "$SOURCE_PATH"
-
-if [ $? -ne 0 ]; then
-    echo ""
-    echo "Configuration failed!"
-    exit 1
+# Links the image blob object and the prebuilt archives, sets up the unity
+# build and adds -ftime-report (see firmware_hooks.cmake)
+HOOK_ARGS=(
+    -DCMAKE_PROJECT_INCLUDE:FILEPATH="$SCRIPT_DIR/firmware_hooks.cmake"
+    -DLCD_UNITY_BUILD:STRING="$UNITY_BUILD"
+    -DLCD_TIME_REPORT:BOOL="$TIME_REPORT"
+)
+if [ -n "$PREBUILT_PATH" ]; then
+    HOOK_ARGS+=(-DLCD_PREBUILT_DIR:STRING="$PREBUILT_PATH")
+fi
+
+# Compiler cache (ccache) set up by the app, if one was found
+LAUNCHER_ARGS=()
+if [ -n "$LCD_COMPILER_LAUNCHER" ]; then
+    echo "Compiler cache: $LCD_COMPILER_LAUNCHER ($CCACHE_DIR)"
+    LAUNCHER_ARGS=(
+        -DCMAKE_C_COMPILER_LAUNCHER:STRING="$LCD_COMPILER_LAUNCHER"
+        -DCMAKE_CXX_COMPILER_LAUNCHER:STRING="$LCD_COMPILER_LAUNCHER"
+    )
+fi
+
+if [ "$RECONFIGURE" = "1" ]; then
+    # Run CMake with absolute paths and Ninja generator
+    "$CMAKE_PATH/cmake" \
+        -G "Ninja" \
+        -DCMAKE_TOOLCHAIN_FILE="$TOOLCHAIN_FILE" \
+        -DARM_GCC_PATH:STRING="$ARM_GCC_PATH" \
+        -DNRF_SDK_PATH:STRING="$NRF_SDK_PATH" \
+        -DLVGL_PATH:STRING="$LVGL_PATH" \
+        -DIMAGES_PATH:STRING="$IMAGES_PATH" \
+        -DCMAKE_BUILD_TYPE="$BUILD_TYPE" \
+        -DLCD_FIRMWARE_LTO:BOOL="$FIRMWARE_LTO" \
+        "${LAUNCHER_ARGS[@]}" \
+        "${HOOK_ARGS[@]}" \
+        "$SOURCE_PATH" || {
+        echo ""
+        echo "Configuration failed!"
+        exit 1
+    }
+
+    # Written only after a successful configure, so a failed one is retried
+    printf '%s\n' "$STAMP" > "$STAMP_FILE"
+    printf '%s\n' "$GENERATED_SOURCES" > "$SOURCES_FILE"
+else
+    echo "Configuration unchanged, building incrementally"
+fi
+
+# Job count and load limit picked by the app from the cores and free memory
+BUILD_ARGS=()
+if [ -n "$LCD_BUILD_JOBS" ]; then
+    echo "Build jobs: $LCD_BUILD_JOBS, load limit ${LCD_BUILD_LOAD:-none}"
+    BUILD_ARGS=(-- -j "$LCD_BUILD_JOBS")
+    if [ -n "$LCD_BUILD_LOAD" ]; then
+        BUILD_ARGS+=(-l "$LCD_BUILD_LOAD")
+    fi
 fi
 
-"$CMAKE_PATH/cmake" --build .
+"$CMAKE_PATH/cmake" --build . "${BUILD_ARGS[@]}"
@@ -0,0 +1,74 @@
+# firmware_hooks.cmake - App-side additions to the firmware build
+#
+# Injected into the firmware project by the configure scripts through
+# CMAKE_PROJECT_INCLUDE, so the firmware's own CMakeLists.txt stays as it is.
+# Once the top-level CMakeLists.txt has been processed:
+#
+#  - generated_images_blob.o, which the app writes with objcopy in binary
+#    blob mode, is linked into the firmware executable. A new blob then only
+#    relinks the firmware instead of recompiling anything.
+#  - LVGL and the nRF5 SDK are linked from cached archives when
+#    LCD_PREBUILT_DIR is set (see prebuilt_libraries.cmake).
+#  - LVGL and the SDK are compiled as LCD_UNITY_BUILD unity translation
+#    units each when that is above 0 (see unity_build.cmake).
+#  - With LCD_TIME_REPORT on, every C and C++ file is compiled with
+#    -ftime-report, which the app reads from the build output for its build
+#    profile.
+
+if(CMAKE_VERSION VERSION_LESS 3.19)
+    message(STATUS "Firmware hooks: CMake ${CMAKE_VERSION} lacks cmake_language(DEFER), skipping")
+    return()
+endif()
+
+# CMAKE_PROJECT_INCLUDE runs after every project() call; hook the top level once
+if(NOT CMAKE_CURRENT_SOURCE_DIR STREQUAL CMAKE_SOURCE_DIR OR LCD_FIRMWARE_HOOKED)
+    return()
+endif()
+set(LCD_FIRMWARE_HOOKED TRUE)
+
+# Added before the firmware's targets exist, so they and the prebuilt
+# libraries (whose key covers the flags) all get it
+if(LCD_TIME_REPORT)
+    message(STATUS "Firmware hooks: compiling with -ftime-report")
+    add_compile_options($<$<COMPILE_LANGUAGE:C,CXX>:-ftime-report>)
+endif()
+
+# First executable defined by the top-level CMakeLists.txt, or "" if none
+function(_lcd_firmware_target out)
+    get_property(targets DIRECTORY "${CMAKE_SOURCE_DIR}" PROPERTY BUILDSYSTEM_TARGETS)
+    foreach(target IN LISTS targets)
+        get_target_property(type ${target} TYPE)
+        if(type STREQUAL "EXECUTABLE")
+            set(${out} ${target} PARENT_SCOPE)
+            return()
+        endif()
+    endforeach()
+    set(${out} "" PARENT_SCOPE)
+endfunction()
+
+# The object only exists in blob mode; the configure scripts reconfigure when
+# it appears or disappears, and ninja relinks whenever it changes
+function(_lcd_link_image_blob)
+    set(blob "${IMAGES_PATH}/generated_images_blob.o")
+    if(NOT IMAGES_PATH OR NOT EXISTS "${blob}")
+        return()
+    endif()
+    _lcd_firmware_target(firmware)
+    if(NOT firmware)
+        message(STATUS "Firmware hooks: no firmware executable found, not linking ${blob}")
+        return()
+    endif()
+    message(STATUS "Firmware hooks: linking ${blob} into ${firmware}")
+    target_sources(${firmware} PRIVATE "${blob}")
+endfunction()
+
+cmake_language(DEFER DIRECTORY "${CMAKE_SOURCE_DIR}" CALL _lcd_link_image_blob)
+
+if(LCD_PREBUILT_DIR)
+    include("${CMAKE_CURRENT_LIST_DIR}/prebuilt_libraries.cmake")
+endif()
+
+# After the prebuilt libraries, so it sees the sources they took over
+if(LCD_UNITY_BUILD GREATER 0)
+    include("${CMAKE_CURRENT_LIST_DIR}/unity_build.cmake")
+endif()
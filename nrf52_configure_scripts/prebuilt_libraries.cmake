@@ -0,0 +1,162 @@
+# prebuilt_libraries.cmake - Links LVGL and the nRF5 SDK from cached archives
+#
+# Included by firmware_hooks.cmake when LCD_PREBUILT_DIR is set. Once the
+# top-level CMakeLists.txt of the firmware has been processed, the .c files the
+# firmware executable compiles from LVGL_PATH and NRF_SDK_PATH are moved into
+# two static libraries.
+#
+# The archives are keyed by the LVGL and SDK versions, the lv_conf.h and
+# sdk_config.h contents, the compiler version, every flag they are built
+# with and the unity build setting, and stored under LCD_PREBUILT_DIR/<key>/.
+# The first build for a key compiles them and copies them there; every later
+# configure with the same key links the stored archives and compiles none of
+# those sources.
+#
+# Both archives are linked with --whole-archive, so the image contains the
+# same objects as before: SDK modules that only register themselves through
+# NRF_SECTION_ITEM or override weak IRQ handlers are not dropped.
+
+if(NOT LVGL_PATH OR NOT NRF_SDK_PATH)
+    message(STATUS "Prebuilt libraries: LVGL_PATH or NRF_SDK_PATH not set, building from source")
+    return()
+endif()
+
+# First file named `name` in `directories`, for hashing configuration headers
+function(_lcd_find_header name directories out)
+    foreach(directory IN LISTS directories)
+        if(NOT directory MATCHES "\\$<" AND EXISTS "${directory}/${name}")
+            set(${out} "${directory}/${name}" PARENT_SCOPE)
+            return()
+        endif()
+    endforeach()
+    set(${out} "" PARENT_SCOPE)
+endfunction()
+
+function(_lcd_use_prebuilt_libraries)
+    _lcd_firmware_target(firmware)
+    if(NOT firmware)
+        message(STATUS "Prebuilt libraries: no firmware executable found, building from source")
+        return()
+    endif()
+
+    # Split the firmware's sources; assembly (startup code) stays in the executable
+    get_target_property(sources ${firmware} SOURCES)
+    get_target_property(source_dir ${firmware} SOURCE_DIR)
+    get_filename_component(lvgl_root "${LVGL_PATH}" ABSOLUTE)
+    get_filename_component(sdk_root "${NRF_SDK_PATH}" ABSOLUTE)
+    set(kept "")
+    set(lvgl_sources "")
+    set(sdk_sources "")
+    foreach(source IN LISTS sources)
+        if(source MATCHES "\\$<" OR NOT source MATCHES "\\.c$")
+            list(APPEND kept "${source}")
+            continue()
+        endif()
+        get_filename_component(path "${source}" ABSOLUTE BASE_DIR "${source_dir}")
+        string(FIND "${path}" "${lvgl_root}/" in_lvgl)
+        string(FIND "${path}" "${sdk_root}/" in_sdk)
+        if(in_lvgl EQUAL 0)
+            list(APPEND lvgl_sources "${path}")
+        elseif(in_sdk EQUAL 0)
+            list(APPEND sdk_sources "${path}")
+        else()
+            list(APPEND kept "${source}")
+        endif()
+    endforeach()
+    if(NOT lvgl_sources AND NOT sdk_sources)
+        message(STATUS "Prebuilt libraries: ${firmware} compiles no LVGL or SDK sources itself, nothing to prebuild")
+        return()
+    endif()
+
+    # Everything that changes the objects goes into the key
+    get_target_property(options ${firmware} COMPILE_OPTIONS)
+    get_target_property(definitions ${firmware} COMPILE_DEFINITIONS)
+    get_target_property(includes ${firmware} INCLUDE_DIRECTORIES)
+    get_target_property(libraries ${firmware} LINK_LIBRARIES)
+    string(TOUPPER "${CMAKE_BUILD_TYPE}" build_type)
+    _lcd_find_header(lv_conf.h "${includes};${LVGL_PATH}/..;${LVGL_PATH}" lv_conf)
+    _lcd_find_header(sdk_config.h "${includes}" sdk_config)
+    set(lv_conf_hash "none")
+    if(lv_conf)
+        file(SHA256 "${lv_conf}" lv_conf_hash)
+    endif()
+    set(sdk_config_hash "none")
+    if(sdk_config)
+        file(SHA256 "${sdk_config}" sdk_config_hash)
+    endif()
+    set(sdk_version "unknown")
+    if(EXISTS "${NRF_SDK_PATH}/documentation/release_notes.txt")
+        file(STRINGS "${NRF_SDK_PATH}/documentation/release_notes.txt" sdk_version LIMIT_COUNT 1)
+    endif()
+    set(lvgl_version "unknown")
+    if(EXISTS "${LVGL_PATH}/lv_version.h")
+        file(STRINGS "${LVGL_PATH}/lv_version.h" lvgl_version REGEX "#define LVGL_VERSION_(MAJOR|MINOR|PATCH)[ \t]")
+    endif()
+
+    string(CONCAT fingerprint
+        "format=1\n"
+        "lvgl=${lvgl_version}\nsdk=${sdk_version}\n"
+        "lv_conf=${lv_conf_hash}\nsdk_config=${sdk_config_hash}\n"
+        "compiler=${CMAKE_C_COMPILER_ID} ${CMAKE_C_COMPILER_VERSION}\n"
+        "flags=${CMAKE_C_FLAGS} ${CMAKE_C_FLAGS_${build_type}}\n"
+        "options=${options}\ndefinitions=${definitions}\nincludes=${includes}\n"
+        "libraries=${libraries}\n"
+        "lvgl_sources=${lvgl_sources}\nsdk_sources=${sdk_sources}\n")
+    # Only when on, so the keys of existing archives stay the same
+    if(LCD_UNITY_BUILD GREATER 0)
+        string(APPEND fingerprint "unity=${LCD_UNITY_BUILD}\n")
+    endif()
+    string(SHA256 key "${fingerprint}")
+    string(SUBSTRING "${key}" 0 16 key)
+    set(archive_dir "${LCD_PREBUILT_DIR}/${key}")
+
+    set_property(TARGET ${firmware} PROPERTY SOURCES ${kept})
+    set(archives "")
+    foreach(part lvgl nrf5_sdk)
+        if(part STREQUAL "lvgl")
+            set(part_sources ${lvgl_sources})
+        else()
+            set(part_sources ${sdk_sources})
+        endif()
+        if(NOT part_sources)
+            continue()
+        endif()
+
+        set(library lcd_prebuilt_${part})
+        set(archive "${archive_dir}/${CMAKE_STATIC_LIBRARY_PREFIX}${library}${CMAKE_STATIC_LIBRARY_SUFFIX}")
+        if(EXISTS "${archive}")
+            list(LENGTH part_sources count)
+            message(STATUS "Prebuilt libraries: linking ${archive} instead of compiling ${count} sources")
+            add_library(${library} STATIC IMPORTED)
+            set_target_properties(${library} PROPERTIES IMPORTED_LOCATION "${archive}")
+        else()
+            message(STATUS "Prebuilt libraries: building ${library} for ${archive_dir}")
+            # Created in the firmware's directory, so directory-level flags
+            # apply; the firmware's own target flags are copied on top
+            add_library(${library} STATIC ${part_sources})
+            target_compile_options(${library} PRIVATE $<TARGET_PROPERTY:${firmware},COMPILE_OPTIONS>)
+            target_compile_definitions(${library} PRIVATE $<TARGET_PROPERTY:${firmware},COMPILE_DEFINITIONS>)
+            target_include_directories(${library} PRIVATE $<TARGET_PROPERTY:${firmware},INCLUDE_DIRECTORIES>)
+            # Copied under a temporary name and renamed, so an interrupted
+            # build never leaves a truncated archive to be reused
+            add_custom_command(TARGET ${library} POST_BUILD
+                COMMAND "${CMAKE_COMMAND}" -E make_directory "${archive_dir}"
+                COMMAND "${CMAKE_COMMAND}" -E copy "$<TARGET_FILE:${library}>" "${archive}.tmp"
+                COMMAND "${CMAKE_COMMAND}" -E rename "${archive}.tmp" "${archive}"
+                VERBATIM)
+        endif()
+        list(APPEND archives ${library})
+    endforeach()
+
+    # The Generic system of the toolchain file defines no WHOLE_ARCHIVE
+    # feature, so the flags are spelled out there
+    if(CMAKE_VERSION VERSION_GREATER_EQUAL 3.24 AND CMAKE_LINK_LIBRARY_USING_WHOLE_ARCHIVE_SUPPORTED)
+        foreach(library IN LISTS archives)
+            target_link_libraries(${firmware} PRIVATE "$<LINK_LIBRARY:WHOLE_ARCHIVE,${library}>")
+        endforeach()
+    else()
+        target_link_libraries(${firmware} PRIVATE -Wl,--whole-archive ${archives} -Wl,--no-whole-archive)
+    endif()
+endfunction()
+
+cmake_language(DEFER DIRECTORY "${CMAKE_SOURCE_DIR}" CALL _lcd_use_prebuilt_libraries)
@@ -31,6 +31,43 @@ else()
     set(CMAKE_SIZE "${ARM_GCC_PATH}/bin/arm-none-eabi-size")
 endif()
 
+# The gcc wrappers load the LTO plugin, so archives of LTO objects (the
+# prebuilt LVGL and SDK libraries) get a symbol index the linker can use
+if(WIN32)
+    set(CMAKE_AR "${ARM_GCC_PATH}/bin/arm-none-eabi-gcc-ar.exe" CACHE FILEPATH "Archiver")
+    set(CMAKE_RANLIB "${ARM_GCC_PATH}/bin/arm-none-eabi-gcc-ranlib.exe" CACHE FILEPATH "Ranlib")
+else()
+    set(CMAKE_AR "${ARM_GCC_PATH}/bin/arm-none-eabi-gcc-ar" CACHE FILEPATH "Archiver")
+    set(CMAKE_RANLIB "${ARM_GCC_PATH}/bin/arm-none-eabi-gcc-ranlib" CACHE FILEPATH "Ranlib")
+endif()
+
+# Firmware profiles. Release (-O2) and MinSizeRel (-Os) put every function
+# and object in its own section and let the linker drop the unreferenced
+# ones. With LCD_FIRMWARE_LTO ON they also optimize across files with LTO;
+# the objects then hold only the compiler's IR, so every link, including
+# the relink after an image-only change, generates the code for LVGL and the
+# SDK again. -flto=auto spreads that over the cores. Debug keeps the compiler defaults. These are the per-configuration cache
+# entries, which CMake only fills with its own defaults (-O3 for Release)
+# when they are not set yet, and the firmware's own flags still apply on
+# top. The nRF5 SDK linker scripts KEEP the sections its modules register
+# themselves in, so --gc-sections does not drop them.
+set(LCD_SECTION_FLAGS "-ffunction-sections -fdata-sections")
+set(LCD_LTO_FLAGS "")
+if(LCD_FIRMWARE_LTO)
+    set(LCD_LTO_FLAGS "-flto=auto")
+endif()
+foreach(lang C CXX)
+    set(CMAKE_${lang}_FLAGS_RELEASE "-O2 -DNDEBUG ${LCD_SECTION_FLAGS} ${LCD_LTO_FLAGS}"
+        CACHE STRING "Flags used by the ${lang} compiler during Release builds")
+    set(CMAKE_${lang}_FLAGS_MINSIZEREL "-Os -DNDEBUG ${LCD_SECTION_FLAGS} ${LCD_LTO_FLAGS}"
+        CACHE STRING "Flags used by the ${lang} compiler during MinSizeRel builds")
+endforeach()
+# LTO generates the code at link time, so the link needs the level as well
+set(CMAKE_EXE_LINKER_FLAGS_RELEASE "-O2 ${LCD_LTO_FLAGS} -Wl,--gc-sections"
+    CACHE STRING "Flags used by the linker during Release builds")
+set(CMAKE_EXE_LINKER_FLAGS_MINSIZEREL "-Os ${LCD_LTO_FLAGS} -Wl,--gc-sections"
+    CACHE STRING "Flags used by the linker during MinSizeRel builds")
+
 # Skip compiler tests for cross-compilation
 set(CMAKE_C_COMPILER_WORKS 1)
 set(CMAKE_CXX_COMPILER_WORKS 1)
@@ -0,0 +1,155 @@
+# unity_build.cmake - Compiles LVGL and the nRF5 SDK as unity translation units
+#
+# Included by firmware_hooks.cmake when LCD_UNITY_BUILD is above 0. Once the
+# top-level CMakeLists.txt of the firmware has been processed, the LVGL and
+# SDK .c files of the firmware executable, or of the prebuilt libraries when
+# those are being built (see prebuilt_libraries.cmake), are split into
+# LCD_UNITY_BUILD groups each. CMake compiles every group as one file that
+# includes its sources, so the shared headers are parsed once per group
+# instead of once per source.
+#
+# Unity builds fail when two sources of a group define the same file-scope
+# name, which LVGL does a lot (draw_main, MY_CLASS, the glyph tables of every
+# font). Each source is scanned for its file-scope statics, typedefs and
+# macros and goes into the first group, starting from its position in the
+# list, that defines none of them yet; sources that clash with every group
+# are compiled on their own. The firmware's own sources, the generated image
+# sources and assembly are never grouped, so they still rebuild on their own.
+
+if(NOT LVGL_PATH OR NOT NRF_SDK_PATH)
+    message(STATUS "Unity build: LVGL_PATH or NRF_SDK_PATH not set, compiling every source on its own")
+    return()
+endif()
+
+# Names the source defines at file scope. Only lines that start at column 0
+# are looked at, which is how both LVGL and the SDK write them.
+function(_lcd_unity_names source out)
+    file(STRINGS "${source}" lines REGEX "^(static|typedef|#[ \t]*define|})")
+    set(names "")
+    # One MATCHES per if(): a failed match clears CMAKE_MATCH_1
+    foreach(line IN LISTS lines)
+        if(line MATCHES "^#[ \t]*define[ \t]+([A-Za-z_][A-Za-z0-9_]*)")
+        elseif(line MATCHES "^static[^(=]*[ *]([A-Za-z_][A-Za-z0-9_]*)[ \t]*[[(=;]")
+        elseif(line MATCHES "^}[ \t]*([A-Za-z_][A-Za-z0-9_]*)[ \t]*;")
+        elseif(line MATCHES "^typedef[^(]*[ *]([A-Za-z_][A-Za-z0-9_]*)[ \t]*;")
+        else()
+            continue()
+        endif()
+        list(APPEND names "${CMAKE_MATCH_1}")
+    endforeach()
+    list(REMOVE_DUPLICATES names)
+    set(${out} "${names}" PARENT_SCOPE)
+endfunction()
+
+# Puts `sources` into LCD_UNITY_BUILD groups named <prefix>_<n>; the prefix
+# ends up in the unity file names, which is how the app's build profile
+# tells LVGL and SDK units apart
+function(_lcd_unity_group sources prefix)
+    list(LENGTH sources count)
+    if(count EQUAL 0)
+        return()
+    endif()
+    set(groups ${LCD_UNITY_BUILD})
+    if(groups GREATER count)
+        set(groups ${count})
+    endif()
+    math(EXPR capacity "(${count} + ${groups} - 1) / ${groups}")
+    math(EXPR last "${groups} - 1")
+    foreach(group RANGE ${last})
+        set(size_${group} 0)
+    endforeach()
+
+    set(index 0)
+    set(alone 0)
+    foreach(source IN LISTS sources)
+        _lcd_unity_names("${source}" names)
+        # Neighbouring sources share most headers, so try the group the
+        # source's position falls into first
+        math(EXPR preferred "${index} * ${groups} / ${count}")
+        math(EXPR index "${index} + 1")
+        set(chosen "")
+        foreach(offset RANGE ${last})
+            math(EXPR group "(${preferred} + ${offset}) % ${groups}")
+            if(NOT size_${group} LESS capacity)
+                continue()
+            endif()
+            set(clash FALSE)
+            foreach(name IN LISTS names)
+                if(DEFINED defined_${group}_${name})
+                    set(clash TRUE)
+                    break()
+                endif()
+            endforeach()
+            if(NOT clash)
+                set(chosen ${group})
+                break()
+            endif()
+        endforeach()
+
+        if(chosen STREQUAL "")
+            math(EXPR alone "${alone} + 1")
+            set_source_files_properties("${source}" PROPERTIES SKIP_UNITY_BUILD_INCLUSION ON)
+            continue()
+        endif()
+        foreach(name IN LISTS names)
+            set(defined_${chosen}_${name} TRUE)
+        endforeach()
+        math(EXPR size_${chosen} "${size_${chosen}} + 1")
+        set_source_files_properties("${source}" PROPERTIES UNITY_GROUP "${prefix}_${chosen}")
+    endforeach()
+
+    math(EXPR grouped "${count} - ${alone}")
+    message(STATUS "Unity build: ${grouped} ${prefix} sources in ${groups} units, ${alone} compiled on their own")
+endfunction()
+
+function(_lcd_use_unity_build)
+    _lcd_firmware_target(firmware)
+    if(NOT firmware)
+        message(STATUS "Unity build: no firmware executable found, compiling every source on its own")
+        return()
+    endif()
+
+    get_filename_component(lvgl_root "${LVGL_PATH}" ABSOLUTE)
+    get_filename_component(sdk_root "${NRF_SDK_PATH}" ABSOLUTE)
+    # Runs after prebuilt_libraries.cmake, which may have moved the sources
+    # into its libraries; imported ones compile nothing
+    foreach(target ${firmware} lcd_prebuilt_lvgl lcd_prebuilt_nrf5_sdk)
+        if(NOT TARGET ${target})
+            continue()
+        endif()
+        get_target_property(imported ${target} IMPORTED)
+        if(imported)
+            continue()
+        endif()
+
+        get_target_property(sources ${target} SOURCES)
+        get_target_property(source_dir ${target} SOURCE_DIR)
+        set(lvgl_sources "")
+        set(sdk_sources "")
+        foreach(source IN LISTS sources)
+            if(source MATCHES "\\$<" OR NOT source MATCHES "\\.c$")
+                continue()
+            endif()
+            get_filename_component(path "${source}" ABSOLUTE BASE_DIR "${source_dir}")
+            string(FIND "${path}" "${lvgl_root}/" in_lvgl)
+            string(FIND "${path}" "${sdk_root}/" in_sdk)
+            if(in_lvgl EQUAL 0)
+                list(APPEND lvgl_sources "${path}")
+            elseif(in_sdk EQUAL 0)
+                list(APPEND sdk_sources "${path}")
+            endif()
+        endforeach()
+        if(NOT lvgl_sources AND NOT sdk_sources)
+            continue()
+        endif()
+
+        # Sources without a UNITY_GROUP are compiled on their own in GROUP mode
+        set_target_properties(${target} PROPERTIES UNITY_BUILD ON UNITY_BUILD_MODE GROUP)
+        list(SORT lvgl_sources)
+        list(SORT sdk_sources)
+        _lcd_unity_group("${lvgl_sources}" lvgl)
+        _lcd_unity_group("${sdk_sources}" nrf5_sdk)
+    endforeach()
+endfunction()
+
+cmake_language(DEFER DIRECTORY "${CMAKE_SOURCE_DIR}" CALL _lcd_use_unity_build)
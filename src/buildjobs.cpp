@@ -0,0 +1,99 @@
+#include "buildjobs.h"
+#include <QFile>
+#include <QSettings>
+#include <QThread>
+#include <algorithm>
+
+#if defined(Q_OS_WIN)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#elif defined(Q_OS_MACOS)
+#include <mach/mach.h>
+#endif
+
+BuildJobs::Plan BuildJobs::plan() {
+  QSettings settings;
+  Plan plan;
+  plan.cores = std::max(1, QThread::idealThreadCount());
+  plan.reservedCores = qBound(
+      0, settings.value("build/reservedCores", 1).toInt(), plan.cores - 1);
+  plan.loadLimit = plan.cores - plan.reservedCores;
+  plan.availableMemory = availableMemoryBytes();
+
+  const int fixedJobs = settings.value("build/jobs", 0).toInt();
+  if (fixedJobs > 0) {
+    plan.jobs = fixedJobs;
+    plan.fixed = true;
+    return plan;
+  }
+
+  plan.jobs = plan.cores - plan.reservedCores;
+  const qint64 perJob =
+      std::max<qint64>(1, settings.value("build/memoryPerJobMB", 400)
+                              .toLongLong()) *
+      1024 * 1024;
+  if (plan.availableMemory > 0) {
+    const int byMemory =
+        int(std::max<qint64>(1, plan.availableMemory / perJob));
+    if (byMemory < plan.jobs) {
+      plan.jobs = byMemory;
+      plan.memoryBound = true;
+    }
+  }
+  return plan;
+}
+
+qint64 BuildJobs::availableMemoryBytes() {
+#if defined(Q_OS_WIN)
+  MEMORYSTATUSEX status;
+  status.dwLength = sizeof(status);
+  if (GlobalMemoryStatusEx(&status)) {
+    return qint64(status.ullAvailPhys);
+  }
+#elif defined(Q_OS_MACOS)
+  // Free plus inactive pages, which the kernel hands out without paging
+  vm_statistics64_data_t vm;
+  mach_msg_type_number_t count = HOST_VM_INFO64_COUNT;
+  if (host_statistics64(mach_host_self(), HOST_VM_INFO64,
+                        reinterpret_cast<host_info64_t>(&vm),
+                        &count) == KERN_SUCCESS) {
+    return qint64(vm.free_count + vm.inactive_count) * qint64(vm_page_size);
+  }
+#else
+  QFile meminfo("/proc/meminfo");
+  if (meminfo.open(QIODevice::ReadOnly | QIODevice::Text)) {
+    while (!meminfo.atEnd()) {
+      const QByteArray line = meminfo.readLine();
+      if (line.startsWith("MemAvailable:")) {
+        // "MemAvailable:   12345678 kB"
+        return line.mid(13).trimmed().split(' ').value(0).toLongLong() * 1024;
+      }
+    }
+  }
+#endif
+  return -1;
+}
+
+void BuildJobs::configure(const Plan &plan, QProcessEnvironment &environment) {
+  environment.insert("LCD_BUILD_JOBS", QString::number(plan.jobs));
+  environment.insert("LCD_BUILD_LOAD", QString::number(plan.loadLimit));
+}
+
+QString BuildJobs::describe(const Plan &plan) {
+  QString text = QString("Build jobs: -j%1 -l%2 (%3 cores, %4 reserved")
+                     .arg(plan.jobs)
+                     .arg(plan.loadLimit)
+                     .arg(plan.cores)
+                     .arg(plan.reservedCores);
+  if (plan.availableMemory > 0) {
+    text += QString(", %1 MiB available").arg(plan.availableMemory >> 20);
+  }
+  if (plan.fixed) {
+    text += ", set by build/jobs";
+  } else if (plan.memoryBound) {
+    text += ", limited by memory";
+  }
+  return text + ")";
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <QProcessEnvironment>
+#include <QString>
+#include <QStringList>
+
+// How many steps the firmware build runs at once.
+//
+// Ninja defaults to cores + 2 jobs with no load limit, which starves the GUI
+// on a 4-core flashing station and can run a small machine out of memory.
+// The plan leaves build/reservedCores cores to the app, caps the jobs by the
+// memory available at build time (build/memoryPerJobMB per compiler) and
+// stops ninja from starting new steps while the load average is above the
+// remaining cores. build/jobs overrides the job count when set.
+class BuildJobs {
+public:
+  struct Plan {
+    int jobs = 1;
+    // ninja -l: no new steps while the load average is above this
+    int loadLimit = 1;
+    int cores = 1;
+    int reservedCores = 0;
+    // -1 when it cannot be read on this platform
+    qint64 availableMemory = -1;
+    // The job count was lowered to fit the available memory
+    bool memoryBound = false;
+    // The job count comes from build/jobs
+    bool fixed = false;
+  };
+
+  static Plan plan();
+
+  // Physical memory that can be used without swapping, or -1 if unknown
+  static qint64 availableMemoryBytes();
+
+  // Exports the plan as LCD_BUILD_JOBS and LCD_BUILD_LOAD for the
+  // configure scripts
+  static void configure(const Plan &plan, QProcessEnvironment &environment);
+  // One line for the log
+  static QString describe(const Plan &plan);
+};
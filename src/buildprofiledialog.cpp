@@ -0,0 +1,202 @@
+#include "buildprofiledialog.h"
+#include <QDialogButtonBox>
+#include <QFileDialog>
+#include <QHash>
+#include <QHeaderView>
+#include <QLabel>
+#include <QMessageBox>
+#include <QPushButton>
+#include <QStandardPaths>
+#include <QTableWidget>
+#include <QVBoxLayout>
+
+namespace {
+// Sorts by value rather than by text
+QTableWidgetItem *numberItem(qint64 value) {
+  auto item = new QTableWidgetItem;
+  item->setData(Qt::DisplayRole, value);
+  item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+  return item;
+}
+
+QTableWidgetItem *textItem(const QString &text) {
+  return new QTableWidgetItem(text);
+}
+
+QTableWidget *createTable(const QStringList &headers) {
+  auto table = new QTableWidget(0, headers.size());
+  table->setHorizontalHeaderLabels(headers);
+  table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+  table->setSelectionBehavior(QAbstractItemView::SelectRows);
+  table->setSelectionMode(QAbstractItemView::SingleSelection);
+  table->verticalHeader()->setVisible(false);
+  table->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+  return table;
+}
+}  // namespace
+
+BuildProfileDialog::BuildProfileDialog(QWidget *parent) : QDialog(parent) {
+  setWindowTitle("Firmware Build Profile");
+  resize(900, 640);
+
+  auto layout = new QVBoxLayout(this);
+
+  QStringList historyHeaders{"Finished", "Kind", "Total (ms)", "Steps"};
+  for (const QString &category : BuildProfiler::categories()) {
+    historyHeaders << QString("%1 (ms)").arg(category);
+  }
+  m_historyTable = createTable(historyHeaders);
+  m_historyTable->setMaximumHeight(180);
+  layout->addWidget(m_historyTable);
+
+  m_summaryLabel = new QLabel;
+  m_summaryLabel->setWordWrap(true);
+  m_summaryLabel->setStyleSheet("color: #666; font-size: 11px;");
+  layout->addWidget(m_summaryLabel);
+
+  m_stepsTable =
+      createTable({"#", "Step", "Category", "Time (ms)", "Previous (ms)",
+                   "Change (ms)", "Parse (ms)", "Codegen (ms)"});
+  m_stepsTable->horizontalHeader()->setSectionResizeMode(
+      1, QHeaderView::Stretch);
+  m_stepsTable->setSortingEnabled(true);
+  layout->addWidget(m_stepsTable, 1);
+
+  auto buttons = new QDialogButtonBox(QDialogButtonBox::Close);
+  m_exportButton = buttons->addButton("Export JSON...",
+                                      QDialogButtonBox::ActionRole);
+  m_clearButton =
+      buttons->addButton("Clear History", QDialogButtonBox::ResetRole);
+  connect(buttons, &QDialogButtonBox::rejected, this, &QDialog::reject);
+  connect(m_exportButton, &QPushButton::clicked, this,
+          &BuildProfileDialog::exportHistory);
+  connect(m_clearButton, &QPushButton::clicked, this,
+          &BuildProfileDialog::clearHistory);
+  layout->addWidget(buttons);
+
+  connect(m_historyTable, &QTableWidget::currentCellChanged, this,
+          [this](int row) { showBuild(row); });
+
+  loadHistory();
+}
+
+void BuildProfileDialog::loadHistory() {
+  m_builds = m_profiler.history();
+  m_exportButton->setEnabled(!m_builds.isEmpty());
+  m_clearButton->setEnabled(!m_builds.isEmpty());
+
+  m_historyTable->setRowCount(m_builds.size());
+  const QStringList categories = BuildProfiler::categories();
+  for (int row = 0; row < m_builds.size(); ++row) {
+    const BuildProfiler::Build &build = m_builds[m_builds.size() - 1 - row];
+    m_historyTable->setItem(
+        row, 0, textItem(build.finished.toString("yyyy-MM-dd hh:mm:ss")));
+    m_historyTable->setItem(row, 1, textItem(build.kind));
+    m_historyTable->setItem(row, 2, numberItem(build.wallMs));
+    m_historyTable->setItem(row, 3, numberItem(build.steps.size()));
+    for (int i = 0; i < categories.size(); ++i) {
+      m_historyTable->setItem(row, 4 + i,
+                              numberItem(build.categoryMs(categories[i])));
+    }
+  }
+
+  if (m_builds.isEmpty()) {
+    m_stepsTable->setRowCount(0);
+    m_summaryLabel->setText(
+        "No builds recorded yet. A profile is taken after every successful "
+        "firmware build.");
+    return;
+  }
+  m_historyTable->setCurrentCell(0, 0);
+  showBuild(0);
+}
+
+void BuildProfileDialog::showBuild(int row) {
+  if (row < 0 || row >= m_builds.size()) {
+    return;
+  }
+  const int index = m_builds.size() - 1 - row;
+  const BuildProfiler::Build &build = m_builds[index];
+
+  // What each step took the last time it ran before this build
+  QHash<QString, qint64> previous;
+  for (int i = 0; i < index; ++i) {
+    for (const BuildProfiler::Step &step : m_builds[i].steps) {
+      previous.insert(step.output, step.ms);
+    }
+  }
+
+  qint64 stepMs = 0;
+  bool timeReport = false;
+  m_stepsTable->setSortingEnabled(false);
+  m_stepsTable->setRowCount(build.steps.size());
+  for (int i = 0; i < build.steps.size(); ++i) {
+    const BuildProfiler::Step &step = build.steps[i];
+    stepMs += step.ms;
+    m_stepsTable->setItem(i, 0, numberItem(i + 1));
+    QTableWidgetItem *name = textItem(BuildProfiler::displayName(step.output));
+    name->setToolTip(step.output);
+    m_stepsTable->setItem(i, 1, name);
+    m_stepsTable->setItem(i, 2, textItem(step.category));
+    m_stepsTable->setItem(i, 3, numberItem(step.ms));
+    const auto before = previous.constFind(step.output);
+    if (before != previous.constEnd()) {
+      m_stepsTable->setItem(i, 4, numberItem(*before));
+      m_stepsTable->setItem(i, 5, numberItem(step.ms - *before));
+    } else {
+      m_stepsTable->setItem(i, 4, textItem(QString()));
+      m_stepsTable->setItem(i, 5, textItem(QString()));
+    }
+    m_stepsTable->setItem(i, 6, step.parseMs >= 0 ? numberItem(step.parseMs)
+                                                  : textItem(QString()));
+    m_stepsTable->setItem(i, 7, step.codegenMs >= 0
+                                    ? numberItem(step.codegenMs)
+                                    : textItem(QString()));
+    timeReport = timeReport || step.parseMs >= 0 || step.codegenMs >= 0;
+  }
+  m_stepsTable->setSortingEnabled(true);
+  m_stepsTable->sortByColumn(3, Qt::DescendingOrder);
+  m_stepsTable->setColumnHidden(6, !timeReport);
+  m_stepsTable->setColumnHidden(7, !timeReport);
+
+  QString summary =
+      QString("%1 finished %2: %3 steps, %4 ms of step time in %5 ms")
+          .arg(build.kind == "relink" ? "Relink" : "Build")
+          .arg(build.finished.toString("yyyy-MM-dd hh:mm:ss"))
+          .arg(build.steps.size())
+          .arg(stepMs)
+          .arg(build.wallMs);
+  if (!timeReport) {
+    summary += ". Turn on build/timeReport to see the parse and code "
+               "generation time of each file.";
+  }
+  m_summaryLabel->setText(summary);
+}
+
+void BuildProfileDialog::exportHistory() {
+  const QString path = QFileDialog::getSaveFileName(
+      this, "Export Build Profile",
+      QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation) +
+          "/build_profiles.json",
+      "JSON files (*.json)");
+  if (path.isEmpty()) {
+    return;
+  }
+  QString error;
+  if (!m_profiler.exportHistory(path, error)) {
+    QMessageBox::critical(this, "Export Failed", error);
+  }
+}
+
+void BuildProfileDialog::clearHistory() {
+  if (QMessageBox::question(this, "Clear History",
+                            "Remove all recorded build profiles?") !=
+      QMessageBox::Yes) {
+    return;
+  }
+  QString error;
+  if (!m_profiler.clearHistory(error)) {
+    QMessageBox::critical(this, "Clear Failed", error);
+  }
+  loadHistory();
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "buildprofiler.h"
+#include <QDialog>
+
+class QLabel;
+class QPushButton;
+class QTableWidget;
+
+// Shows the recorded firmware builds (see BuildProfiler), newest first, and
+// the steps of the selected one ranked by time, with what each step took the
+// last time it ran before. The history can be exported to JSON.
+class BuildProfileDialog : public QDialog {
+  Q_OBJECT
+
+public:
+  explicit BuildProfileDialog(QWidget *parent = nullptr);
+
+private:
+  void loadHistory();
+  void showBuild(int row);
+  void exportHistory();
+  void clearHistory();
+
+  BuildProfiler m_profiler;
+  // Oldest first, as stored; the history table lists them newest first
+  QVector<BuildProfiler::Build> m_builds;
+
+  QLabel *m_summaryLabel;
+  QTableWidget *m_historyTable;
+  QTableWidget *m_stepsTable;
+  QPushButton *m_exportButton;
+  QPushButton *m_clearButton;
+};
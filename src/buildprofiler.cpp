@@ -0,0 +1,284 @@
+#include "buildprofiler.h"
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QRegularExpression>
+#include <QSaveFile>
+#include <QSettings>
+#include <QStandardPaths>
+#include <algorithm>
+
+namespace {
+// Bumped when the history file changes incompatibly; older files are dropped
+const int HISTORY_VERSION = 1;
+
+bool isObject(const QString &path) {
+  return path.endsWith(".o") || path.endsWith(".obj");
+}
+
+bool isArchive(const QString &path) {
+  return path.endsWith(".a") || path.endsWith(".lib");
+}
+
+// Wall time of a -ftime-report line in ms. The columns are user, system and
+// wall seconds, each followed by a percentage, then the GC memory:
+//  " phase parsing      :   0.13 ( 65%)   0.02 ( 67%)   0.15 ( 65%)  3581k"
+// Older gcc versions add "usr", "sys" and "wall" after the columns.
+qint64 reportWallMs(const QString &columns) {
+  static const QRegularExpression seconds("(\\d+\\.\\d+)");
+  QRegularExpressionMatchIterator it = seconds.globalMatch(columns);
+  for (int column = 0; it.hasNext(); ++column) {
+    const QRegularExpressionMatch match = it.next();
+    if (column == 2) {
+      return qRound64(match.captured(1).toDouble() * 1000);
+    }
+  }
+  return -1;
+}
+}  // namespace
+
+qint64 BuildProfiler::Build::categoryMs(const QString &category) const {
+  qint64 total = 0;
+  for (const Step &step : steps) {
+    if (step.category == category) {
+      total += step.ms;
+    }
+  }
+  return total;
+}
+
+BuildProfiler::BuildProfiler(const QString &historyPath)
+    : m_historyPath(historyPath) {}
+
+QString BuildProfiler::defaultHistoryPath() {
+  return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) +
+         "/build_profiles.json";
+}
+
+bool BuildProfiler::timeReportEnabled() {
+  return QSettings().value("build/timeReport", false).toBool();
+}
+
+QStringList BuildProfiler::categories() {
+  return {"LVGL", "nRF5 SDK", "Images", "Firmware", "Link", "Configure"};
+}
+
+QString BuildProfiler::category(const QString &output) {
+  const QString path = QString(output).replace('\\', '/');
+  if (path == "build.ninja") {
+    return "Configure";
+  }
+  if (!isObject(path) && !isArchive(path)) {
+    // The executable, the hex and anything else a custom command produces
+    return "Link";
+  }
+  // Unity files are named after their group (see unity_build.cmake)
+  if (path.contains("libraries/lvgl/") || path.contains("lcd_prebuilt_lvgl") ||
+      path.contains("/unity_lvgl_")) {
+    return "LVGL";
+  }
+  if (path.contains("libraries/nrf5_sdk/") ||
+      path.contains("lcd_prebuilt_nrf5_sdk") ||
+      path.contains("/unity_nrf5_sdk_")) {
+    return "nRF5 SDK";
+  }
+  if (path.contains("/generated/")) {
+    return "Images";
+  }
+  return isArchive(path) ? "Link" : "Firmware";
+}
+
+QString BuildProfiler::displayName(const QString &output) {
+  static const QRegularExpression targetDir("^CMakeFiles/[^/]+\\.dir/");
+  QString name = QString(output).replace('\\', '/');
+  if (!isObject(name)) {
+    return name;
+  }
+  name.remove(targetDir);
+  const int libraries = name.lastIndexOf("libraries/");
+  const int generated = name.lastIndexOf("/generated/");
+  if (libraries >= 0) {
+    name = name.mid(libraries + 10);
+  } else if (generated >= 0) {
+    name = name.mid(generated + 1);
+  }
+  return name.left(name.lastIndexOf('.'));
+}
+
+void BuildProfiler::begin() {
+  m_currentOutput.clear();
+  m_timeReports.clear();
+}
+
+void BuildProfiler::addOutputLine(const QString &line) {
+  static const QRegularExpression status(
+      "^\\[\\d+/\\d+\\]\\s+(?:Building \\S+ object (\\S+))?");
+  static const QRegularExpression phase(
+      "^\\s*phase (parsing|lang\\. deferred|opt and generate)\\s*:(.*)$");
+
+  const QRegularExpressionMatch statusMatch = status.match(line);
+  if (statusMatch.hasMatch()) {
+    // Any other step (link, archive, custom command) ends the attribution
+    m_currentOutput = statusMatch.captured(1).replace('\\', '/');
+    return;
+  }
+  if (m_currentOutput.isEmpty()) {
+    return;
+  }
+  const QRegularExpressionMatch phaseMatch = phase.match(line);
+  if (!phaseMatch.hasMatch()) {
+    return;
+  }
+  const qint64 ms = reportWallMs(phaseMatch.captured(2));
+  if (ms < 0) {
+    return;
+  }
+  TimeReport &report = m_timeReports[m_currentOutput];
+  qint64 &field =
+      phaseMatch.captured(1) == "opt and generate" ? report.codegenMs
+                                                   : report.parseMs;
+  field = std::max<qint64>(field, 0) + ms;
+}
+
+BuildProfiler::Build
+BuildProfiler::finish(const QString &kind,
+                      const QVector<NinjaLog::Entry> &entries, qint64 wallMs) {
+  Build build;
+  build.finished = QDateTime::currentDateTime();
+  build.kind = kind;
+  build.wallMs = wallMs;
+  build.steps.reserve(entries.size());
+  for (const NinjaLog::Entry &entry : entries) {
+    Step step;
+    step.output = QString(entry.output).replace('\\', '/');
+    step.category = category(step.output);
+    step.ms = entry.durationMs();
+    const auto report = m_timeReports.constFind(step.output);
+    if (report != m_timeReports.constEnd()) {
+      step.parseMs = report->parseMs;
+      step.codegenMs = report->codegenMs;
+    }
+    build.steps.append(step);
+  }
+  std::stable_sort(build.steps.begin(), build.steps.end(),
+                   [](const Step &a, const Step &b) { return a.ms > b.ms; });
+  begin();
+
+  QVector<Build> builds = history();
+  builds.append(build);
+  const int keep =
+      std::max(1, QSettings().value("build/profileHistory", 20).toInt());
+  if (builds.size() > keep) {
+    builds.remove(0, builds.size() - keep);
+  }
+  QString error;
+  if (!writeHistory(builds, m_historyPath, false, error)) {
+    qDebug() << "Could not save the build profile:" << error;
+  }
+  return build;
+}
+
+QVector<BuildProfiler::Build> BuildProfiler::history() const {
+  QFile file(m_historyPath);
+  if (!file.open(QIODevice::ReadOnly)) {
+    return {};
+  }
+  const QJsonObject root = QJsonDocument::fromJson(file.readAll()).object();
+  if (root.value("version").toInt() != HISTORY_VERSION) {
+    return {};
+  }
+  QVector<Build> builds;
+  for (const QJsonValue &value : root.value("builds").toArray()) {
+    builds.append(fromJson(value.toObject()));
+  }
+  return builds;
+}
+
+bool BuildProfiler::clearHistory(QString &error) const {
+  if (QFile::exists(m_historyPath) && !QFile::remove(m_historyPath)) {
+    error = QString("Could not remove %1").arg(m_historyPath);
+    return false;
+  }
+  return true;
+}
+
+bool BuildProfiler::exportHistory(const QString &path, QString &error) const {
+  return writeHistory(history(), path, true, error);
+}
+
+QJsonObject BuildProfiler::toJson(const Build &build) {
+  QJsonArray steps;
+  for (const Step &step : build.steps) {
+    QJsonObject object{{"output", step.output},
+                       {"category", step.category},
+                       {"ms", step.ms}};
+    if (step.parseMs >= 0) {
+      object.insert("parseMs", step.parseMs);
+    }
+    if (step.codegenMs >= 0) {
+      object.insert("codegenMs", step.codegenMs);
+    }
+    steps.append(object);
+  }
+  QJsonObject categoryTotals;
+  for (const QString &category : categories()) {
+    categoryTotals.insert(category, build.categoryMs(category));
+  }
+  return {{"finished", build.finished.toString(Qt::ISODate)},
+          {"kind", build.kind},
+          {"wallMs", build.wallMs},
+          // Derived, for readers of the exported file
+          {"categoryMs", categoryTotals},
+          {"steps", steps}};
+}
+
+BuildProfiler::Build BuildProfiler::fromJson(const QJsonObject &object) {
+  Build build;
+  build.finished =
+      QDateTime::fromString(object.value("finished").toString(), Qt::ISODate);
+  build.kind = object.value("kind").toString();
+  build.wallMs = object.value("wallMs").toVariant().toLongLong();
+  for (const QJsonValue &value : object.value("steps").toArray()) {
+    const QJsonObject stepObject = value.toObject();
+    Step step;
+    step.output = stepObject.value("output").toString();
+    step.category = stepObject.value("category").toString();
+    step.ms = stepObject.value("ms").toVariant().toLongLong();
+    step.parseMs = stepObject.contains("parseMs")
+                       ? stepObject.value("parseMs").toVariant().toLongLong()
+                       : -1;
+    step.codegenMs =
+        stepObject.contains("codegenMs")
+            ? stepObject.value("codegenMs").toVariant().toLongLong()
+            : -1;
+    build.steps.append(step);
+  }
+  return build;
+}
+
+bool BuildProfiler::writeHistory(const QVector<Build> &history,
+                                 const QString &path, bool indented,
+                                 QString &error) const {
+  QDir().mkpath(QFileInfo(path).absolutePath());
+  QJsonArray builds;
+  for (const Build &build : history) {
+    builds.append(toJson(build));
+  }
+  const QJsonObject root{{"version", HISTORY_VERSION}, {"builds", builds}};
+
+  QSaveFile file(path);
+  if (!file.open(QIODevice::WriteOnly)) {
+    error = QString("Could not write %1: %2").arg(path, file.errorString());
+    return false;
+  }
+  file.write(QJsonDocument(root).toJson(indented ? QJsonDocument::Indented
+                                                 : QJsonDocument::Compact));
+  if (!file.commit()) {
+    error = QString("Could not write %1: %2").arg(path, file.errorString());
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "ninjalog.h"
+#include <QDateTime>
+#include <QHash>
+#include <QJsonObject>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+// Where the firmware build spends its time, per compile and link step.
+//
+// After each successful build or relink the steps of that run are read from
+// .ninja_log, grouped by what they compile (LVGL, the nRF5 SDK, the generated
+// images, the firmware itself, the link) and appended to a history in the
+// app data directory, which keeps the last build/profileHistory builds
+// (default 20). With build/timeReport on, the firmware is compiled with
+// -ftime-report and the parse and code generation times gcc prints for each
+// translation unit are attached to its step.
+class BuildProfiler {
+public:
+  struct Step {
+    // Path as ninja records it, relative to build_mcu
+    QString output;
+    QString category;
+    qint64 ms = 0;
+    // From -ftime-report, -1 when the step had none
+    qint64 parseMs = -1;
+    qint64 codegenMs = -1;
+  };
+
+  struct Build {
+    QDateTime finished;
+    // "build" for the configure script, "relink" for the fast path
+    QString kind;
+    // The whole stage, including configure
+    qint64 wallMs = 0;
+    // Slowest first
+    QVector<Step> steps;
+
+    qint64 categoryMs(const QString &category) const;
+  };
+
+  explicit BuildProfiler(const QString &historyPath = defaultHistoryPath());
+
+  static QString defaultHistoryPath();
+  static bool timeReportEnabled();
+  // In display order
+  static QStringList categories();
+  static QString category(const QString &output);
+  // Source path of an object file without the CMakeFiles/<target>.dir/
+  // prefix and the libraries/ path in front of it, or the output as it is
+  static QString displayName(const QString &output);
+
+  // Called before each build; forgets the time reports of the last one
+  void begin();
+  // Streamed build output. Ninja prints a step's output right after its
+  // "[n/m] Building C object ..." line, which is where the time reports are
+  // picked up.
+  void addOutputLine(const QString &line);
+  // Turns the log entries into a profile and appends it to the history
+  Build finish(const QString &kind, const QVector<NinjaLog::Entry> &entries,
+               qint64 wallMs);
+
+  // Oldest first; empty when there is no history yet
+  QVector<Build> history() const;
+  bool clearHistory(QString &error) const;
+  bool exportHistory(const QString &path, QString &error) const;
+
+  static QJsonObject toJson(const Build &build);
+  static Build fromJson(const QJsonObject &object);
+
+private:
+  struct TimeReport {
+    qint64 parseMs = -1;
+    qint64 codegenMs = -1;
+  };
+
+  bool writeHistory(const QVector<Build> &history, const QString &path,
+                    bool indented, QString &error) const;
+
+  QString m_historyPath;
+  // Output of the step whose output is being printed, from its status line
+  QString m_currentOutput;
+  QHash<QString, TimeReport> m_timeReports;
+};
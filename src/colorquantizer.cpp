@@ -0,0 +1,395 @@
+#include "colorquantizer.h"
+
+#include <algorithm>
+#include <unordered_map>
+
+namespace {
+
+using ColorQuantizer::Color;
+
+// Distinct color and how many pixels use it
+struct Entry {
+  uint8_t c[4];
+  uint32_t count;
+};
+
+// Half-open range of `entries` owned by one median-cut box, with its split
+// priority cached so picking the next box does not rescan every entry
+struct Box {
+  int begin;
+  int end;
+  int channel;
+  double score;
+};
+
+const int kRefinePasses = 3;
+// Above this many entries the histogram is coarsened a second time
+const size_t kMaxEntries = 8192;
+
+// Fully transparent pixels all collapse to one key regardless of their RGB,
+// which PNG encoders leave as arbitrary garbage.
+inline uint32_t colorKey(const uint8_t *p) {
+  if (p[3] == 0) {
+    return 0;
+  }
+  return uint32_t(p[0]) | uint32_t(p[1]) << 8 | uint32_t(p[2]) << 16 |
+         uint32_t(p[3]) << 24;
+}
+
+inline int distance(const int *v, const Color &c) {
+  const int dr = v[0] - c.r;
+  const int dg = v[1] - c.g;
+  const int db = v[2] - c.b;
+  const int da = v[3] - c.a;
+  return dr * dr + dg * dg + db * db + da * da;
+}
+
+// Nearest-color search over the palette sorted by red. Scanning outward
+// from the closest red value can stop in each direction as soon as the red
+// difference alone exceeds the best distance so far, which skips most of a
+// 256-entry palette.
+class NearestSearch {
+public:
+  explicit NearestSearch(const std::vector<Color> &palette) {
+    m_order.resize(palette.size());
+    for (size_t i = 0; i < palette.size(); ++i) {
+      m_order[i] = int(i);
+    }
+    std::sort(m_order.begin(), m_order.end(), [&palette](int a, int b) {
+      return palette[a].r < palette[b].r;
+    });
+    for (int i : m_order) {
+      m_sorted.push_back(palette[i]);
+    }
+  }
+
+  int find(const int *v) const {
+    const int n = int(m_sorted.size());
+    int up = int(std::lower_bound(m_sorted.begin(), m_sorted.end(), v[0],
+                                  [](const Color &c, int r) { return c.r < r; }) -
+                 m_sorted.begin());
+    int down = up - 1;
+    int best = 0;
+    int bestDistance = 0x7fffffff;
+
+    while (up < n || down >= 0) {
+      if (up < n) {
+        const int dr = m_sorted[up].r - v[0];
+        if (dr * dr >= bestDistance) {
+          up = n;
+        } else {
+          const int d = distance(v, m_sorted[up]);
+          if (d < bestDistance) {
+            bestDistance = d;
+            best = up;
+          }
+          ++up;
+        }
+      }
+      if (down >= 0) {
+        const int dr = v[0] - m_sorted[down].r;
+        if (dr * dr >= bestDistance) {
+          down = -1;
+        } else {
+          const int d = distance(v, m_sorted[down]);
+          if (d < bestDistance) {
+            bestDistance = d;
+            best = down;
+          }
+          --down;
+        }
+      }
+    }
+    return m_order[best];
+  }
+
+private:
+  std::vector<Color> m_sorted;
+  std::vector<int> m_order;
+};
+
+// Widest channel of a box and its extent
+int widestChannel(const std::vector<Entry> &entries, const Box &box,
+                  int &range) {
+  int lo[4] = {255, 255, 255, 255};
+  int hi[4] = {0, 0, 0, 0};
+  for (int i = box.begin; i < box.end; ++i) {
+    for (int ch = 0; ch < 4; ++ch) {
+      lo[ch] = std::min<int>(lo[ch], entries[i].c[ch]);
+      hi[ch] = std::max<int>(hi[ch], entries[i].c[ch]);
+    }
+  }
+  int channel = 0;
+  range = hi[0] - lo[0];
+  for (int ch = 1; ch < 4; ++ch) {
+    if (hi[ch] - lo[ch] > range) {
+      range = hi[ch] - lo[ch];
+      channel = ch;
+    }
+  }
+  return channel;
+}
+
+uint64_t population(const std::vector<Entry> &entries, const Box &box) {
+  uint64_t total = 0;
+  for (int i = box.begin; i < box.end; ++i) {
+    total += entries[i].count;
+  }
+  return total;
+}
+
+// Merges colors that agree in their top `bits` bits per channel into one
+// entry at their pixel-weighted mean. Noisy or photographic images have tens
+// of thousands of distinct colors; this keeps the cut and the k-means passes
+// proportional to a few thousand entries at no visible cost.
+std::vector<Entry> coarsen(const std::vector<Entry> &entries, int bits) {
+  const int shift = 8 - bits;
+  std::unordered_map<uint32_t, size_t> slots;
+  std::vector<uint64_t> sums;
+  for (const Entry &e : entries) {
+    const uint32_t key = uint32_t(e.c[0] >> shift) |
+                         uint32_t(e.c[1] >> shift) << bits |
+                         uint32_t(e.c[2] >> shift) << (2 * bits) |
+                         uint32_t(e.c[3] >> shift) << (3 * bits);
+    auto it = slots.find(key);
+    if (it == slots.end()) {
+      it = slots.emplace(key, sums.size()).first;
+      sums.resize(sums.size() + 5, 0);
+    }
+    uint64_t *s = &sums[it->second];
+    for (int ch = 0; ch < 4; ++ch) {
+      s[ch] += uint64_t(e.c[ch]) * e.count;
+    }
+    s[4] += e.count;
+  }
+
+  // Slots were allocated in `entries` order, which is already sorted
+  std::vector<Entry> merged(sums.size() / 5);
+  for (size_t i = 0; i < merged.size(); ++i) {
+    const uint64_t *s = &sums[i * 5];
+    for (int ch = 0; ch < 4; ++ch) {
+      merged[i].c[ch] = uint8_t((s[ch] + s[4] / 2) / s[4]);
+    }
+    merged[i].count = uint32_t(s[4]);
+  }
+  return merged;
+}
+
+// Boxes are split in order of channel range weighted by pixel count: wide
+// boxes with many pixels contribute the most error.
+Box makeBox(const std::vector<Entry> &entries, int begin, int end) {
+  Box box = {begin, end, 0, -1.0};
+  if (end - begin >= 2) {
+    int range;
+    box.channel = widestChannel(entries, box, range);
+    box.score = double(range) * double(population(entries, box));
+  }
+  return box;
+}
+
+Color weightedMean(const std::vector<Entry> &entries, const Box &box) {
+  uint64_t sum[4] = {0, 0, 0, 0};
+  uint64_t total = 0;
+  for (int i = box.begin; i < box.end; ++i) {
+    for (int ch = 0; ch < 4; ++ch) {
+      sum[ch] += uint64_t(entries[i].c[ch]) * entries[i].count;
+    }
+    total += entries[i].count;
+  }
+  Color c;
+  c.r = uint8_t((sum[0] + total / 2) / total);
+  c.g = uint8_t((sum[1] + total / 2) / total);
+  c.b = uint8_t((sum[2] + total / 2) / total);
+  c.a = uint8_t((sum[3] + total / 2) / total);
+  return c;
+}
+
+// Lloyd iterations over the distinct colors, weighted by pixel count. Median
+// cut places boxes well but its means are biased toward box centers; a few
+// passes noticeably lower the error on smooth gradients.
+void refine(const std::vector<Entry> &entries, std::vector<Color> &palette) {
+  for (int pass = 0; pass < kRefinePasses; ++pass) {
+    const NearestSearch search(palette);
+    std::vector<uint64_t> sums(palette.size() * 5, 0);
+    for (const Entry &e : entries) {
+      const int v[4] = {e.c[0], e.c[1], e.c[2], e.c[3]};
+      uint64_t *s = &sums[size_t(search.find(v)) * 5];
+      for (int ch = 0; ch < 4; ++ch) {
+        s[ch] += uint64_t(e.c[ch]) * e.count;
+      }
+      s[4] += e.count;
+    }
+    for (size_t i = 0; i < palette.size(); ++i) {
+      const uint64_t *s = &sums[i * 5];
+      if (s[4] == 0) {
+        continue; // Keep unused entries where they are
+      }
+      palette[i].r = uint8_t((s[0] + s[4] / 2) / s[4]);
+      palette[i].g = uint8_t((s[1] + s[4] / 2) / s[4]);
+      palette[i].b = uint8_t((s[2] + s[4] / 2) / s[4]);
+      palette[i].a = uint8_t((s[3] + s[4] / 2) / s[4]);
+    }
+  }
+}
+
+} // namespace
+
+namespace ColorQuantizer {
+
+std::vector<Color> buildPalette(const uint8_t *rgba, int width, int height,
+                                int stride, int maxColors, bool &exact) {
+  std::unordered_map<uint32_t, uint32_t> histogram;
+  histogram.reserve(4096);
+  for (int y = 0; y < height; ++y) {
+    const uint8_t *row = rgba + size_t(y) * stride;
+    for (int x = 0; x < width; ++x) {
+      ++histogram[colorKey(row + 4 * x)];
+    }
+  }
+
+  std::vector<Entry> entries;
+  entries.reserve(histogram.size());
+  for (const auto &bucket : histogram) {
+    Entry e;
+    e.c[0] = uint8_t(bucket.first);
+    e.c[1] = uint8_t(bucket.first >> 8);
+    e.c[2] = uint8_t(bucket.first >> 16);
+    e.c[3] = uint8_t(bucket.first >> 24);
+    e.count = bucket.second;
+    entries.push_back(e);
+  }
+  // Hash order is unspecified; sort so the palette is reproducible
+  std::sort(entries.begin(), entries.end(), [](const Entry &a, const Entry &b) {
+    return std::lexicographical_compare(a.c, a.c + 4, b.c, b.c + 4);
+  });
+
+  std::vector<Color> palette;
+  exact = int(entries.size()) <= maxColors;
+  if (exact) {
+    for (const Entry &e : entries) {
+      palette.push_back({e.c[0], e.c[1], e.c[2], e.c[3]});
+    }
+    return palette;
+  }
+  entries = coarsen(entries, 6);
+  if (entries.size() > kMaxEntries) {
+    entries = coarsen(entries, 5);
+  }
+
+  std::vector<Box> boxes;
+  boxes.push_back(makeBox(entries, 0, int(entries.size())));
+  while (int(boxes.size()) < maxColors) {
+    int pick = 0;
+    for (int i = 1; i < int(boxes.size()); ++i) {
+      if (boxes[i].score > boxes[pick].score) {
+        pick = i;
+      }
+    }
+    if (boxes[pick].score < 0.0) {
+      break; // Only single-color boxes left
+    }
+
+    const Box box = boxes[pick];
+    const int channel = box.channel;
+    std::sort(entries.begin() + box.begin, entries.begin() + box.end,
+              [channel](const Entry &a, const Entry &b) {
+                return a.c[channel] < b.c[channel];
+              });
+
+    // Split at the pixel-weighted median, keeping both halves non-empty
+    const uint64_t half = population(entries, box) / 2;
+    uint64_t seen = 0;
+    int split = box.begin + 1;
+    for (int i = box.begin; i < box.end - 1; ++i) {
+      seen += entries[i].count;
+      if (seen >= half) {
+        split = i + 1;
+        break;
+      }
+    }
+
+    boxes[pick] = makeBox(entries, box.begin, split);
+    boxes.push_back(makeBox(entries, split, box.end));
+  }
+
+  for (const Box &box : boxes) {
+    palette.push_back(weightedMean(entries, box));
+  }
+  refine(entries, palette);
+  return palette;
+}
+
+void mapToPalette(const uint8_t *rgba, int width, int height, int stride,
+                  const std::vector<Color> &palette, bool dither,
+                  uint8_t *indices) {
+  const NearestSearch search(palette);
+  if (!dither) {
+    // Icon-like screens repeat few colors; memoize the nearest search
+    std::unordered_map<uint32_t, uint8_t> lookup;
+    for (int y = 0; y < height; ++y) {
+      const uint8_t *row = rgba + size_t(y) * stride;
+      for (int x = 0; x < width; ++x) {
+        const uint32_t key = colorKey(row + 4 * x);
+        auto it = lookup.find(key);
+        if (it == lookup.end()) {
+          const int v[4] = {int(key & 0xff), int(key >> 8 & 0xff),
+                            int(key >> 16 & 0xff), int(key >> 24)};
+          it = lookup.emplace(key, uint8_t(search.find(v))).first;
+        }
+        indices[size_t(y) * width + x] = it->second;
+      }
+    }
+    return;
+  }
+
+  // Error per channel in 1/16 units, padded by one pixel on both sides;
+  // serpentine scan as in PixelKernels::floydSteinbergToRgb565.
+  std::vector<int> current(size_t(width + 2) * 4, 0);
+  std::vector<int> next(size_t(width + 2) * 4, 0);
+
+  for (int y = 0; y < height; ++y) {
+    const uint8_t *row = rgba + size_t(y) * stride;
+    std::fill(next.begin(), next.end(), 0);
+
+    const bool leftToRight = (y % 2) == 0;
+    const int dir = leftToRight ? 1 : -1;
+
+    for (int n = 0; n < width; ++n) {
+      const int x = leftToRight ? n : width - 1 - n;
+      const uint8_t *p = row + 4 * x;
+      int *err = &current[size_t(x + 1) * 4];
+
+      int v[4];
+      for (int ch = 0; ch < 4; ++ch) {
+        v[ch] = std::min(255, std::max(0, p[ch] + ((err[ch] + 8) >> 4)));
+      }
+      if (p[3] == 0) {
+        // Keep transparent areas clean instead of speckling them
+        v[0] = v[1] = v[2] = v[3] = 0;
+      }
+
+      const int index = search.find(v);
+      indices[size_t(y) * width + x] = uint8_t(index);
+
+      if (p[3] == 0) {
+        continue;
+      }
+      const Color &c = palette[index];
+      const int e[4] = {v[0] - c.r, v[1] - c.g, v[2] - c.b, v[3] - c.a};
+      int *ahead = &current[size_t(x + 1 + dir) * 4];
+      int *below = &next[size_t(x + 1) * 4];
+      int *behindBelow = &next[size_t(x + 1 - dir) * 4];
+      int *aheadBelow = &next[size_t(x + 1 + dir) * 4];
+      for (int ch = 0; ch < 4; ++ch) {
+        ahead[ch] += e[ch] * 7;
+        behindBelow[ch] += e[ch] * 3;
+        below[ch] += e[ch] * 5;
+        aheadBelow[ch] += e[ch];
+      }
+    }
+
+    current.swap(next);
+  }
+}
+
+} // namespace ColorQuantizer
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// Palette generation for the indexed LVGL formats (I1-I8), replacing the
+// pngquant step LVGLImage.py depends on. Works on RGBA8888 pixels; alpha is
+// quantized like any other channel so translucent icons keep their edges.
+namespace ColorQuantizer {
+
+struct Color {
+  uint8_t r, g, b, a;
+};
+
+// Median-cut over the image's distinct colors, refined by a few k-means
+// passes. Returns at most `maxColors` entries. `exact` is set when the image
+// has no more distinct colors than that and each one got its own entry;
+// otherwise the palette can have fewer entries and still be lossy.
+std::vector<Color> buildPalette(const uint8_t *rgba, int width, int height,
+                                int stride, int maxColors, bool &exact);
+
+// Writes one palette index per pixel (`width * height` bytes, no padding).
+// With `dither` the residual error is diffused Floyd-Steinberg style.
+void mapToPalette(const uint8_t *rgba, int width, int height, int stride,
+                  const std::vector<Color> &palette, bool dither,
+                  uint8_t *indices);
+
+} // namespace ColorQuantizer
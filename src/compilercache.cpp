@@ -0,0 +1,93 @@
+#include "compilercache.h"
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QProcess>
+#include <QStandardPaths>
+#include <QStringList>
+
+CompilerCache::CompilerCache(const QString &librariesPath,
+                             const QString &directory, qint64 maxBytes)
+    : m_baseDirectory(QFileInfo(librariesPath).absolutePath()),
+      m_directory(directory), m_maxBytes(maxBytes) {
+  m_executable = QStandardPaths::findExecutable(
+      "ccache", {QDir(librariesPath).filePath("ccache")});
+  if (m_executable.isEmpty()) {
+    m_executable = QStandardPaths::findExecutable("ccache");
+  }
+  if (m_executable.isEmpty()) {
+    qDebug() << "ccache not found, firmware builds are not cached";
+    return;
+  }
+  QDir().mkpath(m_directory);
+}
+
+QString CompilerCache::defaultDirectory() {
+  return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) +
+         "/compiler_cache";
+}
+
+void CompilerCache::configure(QProcessEnvironment &environment) const {
+  if (!isAvailable()) {
+    return;
+  }
+  environment.insert("CCACHE_DIR", QDir::toNativeSeparators(m_directory));
+  environment.insert("CCACHE_MAXSIZE",
+                     QString("%1M").arg(qMax<qint64>(1, m_maxBytes >> 20)));
+  // Paths under the install are hashed relative to it, so a moved or
+  // reinstalled app still hits the same entries
+  environment.insert("CCACHE_BASEDIR",
+                     QDir::toNativeSeparators(m_baseDirectory));
+  environment.insert("LCD_COMPILER_LAUNCHER",
+                     QDir::fromNativeSeparators(m_executable));
+}
+
+void CompilerCache::resetStats() const {
+  if (isAvailable()) {
+    run({"--zero-stats"});
+  }
+}
+
+bool CompilerCache::stats(int &hits, int &misses) const {
+  QString output;
+  if (!isAvailable() || !run({"--print-stats"}, &output)) {
+    return false;
+  }
+
+  // Tab-separated "name<TAB>value" lines (ccache 4.x)
+  hits = 0;
+  misses = 0;
+  bool found = false;
+  for (const QString &line : output.split('\n')) {
+    const QStringList fields = line.trimmed().split('\t');
+    if (fields.size() != 2) {
+      continue;
+    }
+    if (fields[0] == "direct_cache_hit" ||
+        fields[0] == "preprocessed_cache_hit") {
+      hits += fields[1].toInt();
+      found = true;
+    } else if (fields[0] == "cache_miss") {
+      misses += fields[1].toInt();
+      found = true;
+    }
+  }
+  return found;
+}
+
+bool CompilerCache::run(const QStringList &arguments, QString *output) const {
+  QProcess process;
+  QProcessEnvironment environment = QProcessEnvironment::systemEnvironment();
+  configure(environment);
+  process.setProcessEnvironment(environment);
+  process.start(m_executable, arguments);
+  if (!process.waitForFinished(10000) || process.exitCode() != 0) {
+    qDebug() << "ccache" << arguments << "failed:"
+             << process.readAllStandardError();
+    return false;
+  }
+  if (output) {
+    *output = QString::fromLocal8Bit(process.readAllStandardOutput());
+  }
+  return true;
+}
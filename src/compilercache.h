@@ -0,0 +1,39 @@
+#pragma once
+
+#include <QProcessEnvironment>
+#include <QString>
+
+// ccache in front of arm-none-eabi-gcc for the firmware build.
+//
+// The cache lives under the app data directory with a size cap, so LVGL and
+// the nRF5 SDK compile once per machine rather than on every clean build.
+// ccache is taken from libraries/ccache when bundled, otherwise from PATH;
+// without one the firmware builds uncached as before.
+class CompilerCache {
+public:
+  CompilerCache(const QString &librariesPath, const QString &directory,
+                qint64 maxBytes);
+
+  static QString defaultDirectory();
+
+  bool isAvailable() const { return !m_executable.isEmpty(); }
+  QString executable() const { return m_executable; }
+
+  // Adds the ccache settings to `environment` and exports the launcher as
+  // LCD_COMPILER_LAUNCHER for the configure scripts. Leaves it unchanged
+  // when no ccache was found.
+  void configure(QProcessEnvironment &environment) const;
+
+  // Zeroes the statistics so stats() covers a single build
+  void resetStats() const;
+  // Hits and misses since resetStats(); false if ccache cannot report them
+  bool stats(int &hits, int &misses) const;
+
+private:
+  bool run(const QStringList &arguments, QString *output = nullptr) const;
+
+  QString m_executable;
+  QString m_baseDirectory;
+  QString m_directory;
+  qint64 m_maxBytes;
+};
@@ -0,0 +1,169 @@
+#include "conversioncache.h"
+#include "librarychecker.h"
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QStandardPaths>
+#include <QThread>
+#include <algorithm>
+
+ConversionCache::ConversionCache(const QString &directory, qint64 maxBytes)
+    : m_directory(directory), m_maxBytes(maxBytes) {
+  QDir().mkpath(m_directory);
+}
+
+QString ConversionCache::defaultDirectory() {
+  return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) +
+         "/conversion_cache";
+}
+
+QByteArray ConversionCache::key(const QByteArray &imageData,
+                                const QString &symbolName,
+                                const QByteArray &optionsFingerprint) {
+  QCryptographicHash hash(QCryptographicHash::Sha256);
+  hash.addData(imageData);
+  hash.addData(QByteArray(1, '\0'));
+  hash.addData(symbolName.toUtf8());
+  hash.addData(QByteArray(1, '\0'));
+  hash.addData(optionsFingerprint);
+  hash.addData(QByteArray(1, '\0'));
+  hash.addData(QByteArray(LibraryChecker::LVGL_VERSION));
+  return hash.result().toHex();
+}
+
+QString ConversionCache::entryPath(const QByteArray &key,
+                                   const char *suffix) const {
+  // Two-level fan-out keeps directories small on large caches
+  const QString name = QString::fromLatin1(key);
+  return m_directory + "/" + name.left(2) + "/" + name + suffix;
+}
+
+void ConversionCache::touch(const QString &path) {
+  // Mark as recently used for LRU eviction
+  QFile entry(path);
+  if (entry.open(QIODevice::ReadWrite)) {
+    entry.setFileTime(QDateTime::currentDateTimeUtc(),
+                      QFileDevice::FileModificationTime);
+  }
+}
+
+void ConversionCache::count(bool hit) {
+  QMutexLocker locker(&m_mutex);
+  if (hit) {
+    ++m_hits;
+  } else {
+    ++m_misses;
+  }
+}
+
+bool ConversionCache::fetchData(const QByteArray &key, QByteArray &data) {
+  const QString path = entryPath(key, ".bin");
+  QFile entry(path);
+  const bool hit = entry.open(QIODevice::ReadOnly);
+  if (hit) {
+    data = entry.readAll();
+    entry.close();
+    touch(path);
+  }
+
+  count(hit);
+  return hit;
+}
+
+void ConversionCache::storeData(const QByteArray &key,
+                                const QByteArray &data) {
+  const QString path = entryPath(key, ".bin");
+  QDir().mkpath(QFileInfo(path).absolutePath());
+
+  // Write under a unique name and rename so a concurrent fetch never sees a
+  // half-written entry.
+  const QString temp =
+      path + QString(".tmp%1").arg(
+                 reinterpret_cast<quintptr>(QThread::currentThreadId()));
+  QFile file(temp);
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) ||
+      file.write(data) != data.size()) {
+    qDebug() << "Failed to store conversion cache entry:" << path;
+    file.remove();
+    return;
+  }
+  file.close();
+  QFile::remove(path);
+  if (!QFile::rename(temp, path)) {
+    QFile::remove(temp);
+  }
+}
+
+void ConversionCache::setMaxBytes(qint64 maxBytes) {
+  QMutexLocker locker(&m_mutex);
+  m_maxBytes = maxBytes;
+}
+
+void ConversionCache::evict() {
+  QMutexLocker locker(&m_mutex);
+
+  QList<QFileInfo> entries;
+  qint64 total = 0;
+  // *.c entries are left over from caches that stored finished sources
+  QDirIterator it(m_directory, {"*.c", "*.bin"}, QDir::Files,
+                  QDirIterator::Subdirectories);
+  while (it.hasNext()) {
+    it.next();
+    entries.append(it.fileInfo());
+    total += it.fileInfo().size();
+  }
+
+  if (total <= m_maxBytes) {
+    return;
+  }
+
+  std::sort(entries.begin(), entries.end(),
+            [](const QFileInfo &a, const QFileInfo &b) {
+              return a.lastModified() < b.lastModified();
+            });
+
+  int removed = 0;
+  for (const QFileInfo &entry : entries) {
+    if (total <= m_maxBytes) {
+      break;
+    }
+    if (QFile::remove(entry.absoluteFilePath())) {
+      total -= entry.size();
+      ++removed;
+    }
+  }
+  qDebug() << "Conversion cache: evicted" << removed << "entries, now"
+           << total / 1024 << "KiB";
+}
+
+void ConversionCache::resetCounters() {
+  QMutexLocker locker(&m_mutex);
+  m_hits = 0;
+  m_misses = 0;
+}
+
+int ConversionCache::hits() const {
+  QMutexLocker locker(&m_mutex);
+  return m_hits;
+}
+
+int ConversionCache::misses() const {
+  QMutexLocker locker(&m_mutex);
+  return m_misses;
+}
+
+qint64 ConversionCache::sizeBytes() const {
+  qint64 total = 0;
+  QDirIterator it(m_directory, {"*.c", "*.bin"}, QDir::Files,
+                  QDirIterator::Subdirectories);
+  while (it.hasNext()) {
+    it.next();
+    total += it.fileInfo().size();
+  }
+  return total;
+}
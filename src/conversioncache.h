@@ -0,0 +1,48 @@
+#pragma once
+
+#include <QByteArray>
+#include <QMutex>
+#include <QString>
+
+// Content-addressed store of generated image sources.
+//
+// Entries are keyed by a SHA-256 over the source image bytes, the symbol
+// name, the converter options and the LVGL version, and hold the serialized
+// encoded pixels (LVGLImageConverter::serialize), from which either output
+// mode writes its sources without converting again. Entries are touched on
+// every hit and the least recently used ones are evicted once the cache grows
+// past its size cap.
+//
+// fetchData()/storeData() may be called concurrently from conversion threads.
+class ConversionCache {
+public:
+  explicit ConversionCache(const QString &directory, qint64 maxBytes);
+
+  static QString defaultDirectory();
+
+  static QByteArray key(const QByteArray &imageData, const QString &symbolName,
+                        const QByteArray &optionsFingerprint);
+
+  bool fetchData(const QByteArray &key, QByteArray &data);
+  void storeData(const QByteArray &key, const QByteArray &data);
+
+  void setMaxBytes(qint64 maxBytes);
+  // Deletes least recently used entries until the cache fits its cap.
+  void evict();
+
+  void resetCounters();
+  int hits() const;
+  int misses() const;
+  qint64 sizeBytes() const;
+
+private:
+  QString entryPath(const QByteArray &key, const char *suffix) const;
+  static void touch(const QString &path);
+  void count(bool hit);
+
+  QString m_directory;
+  qint64 m_maxBytes;
+  mutable QMutex m_mutex;
+  int m_hits = 0;
+  int m_misses = 0;
+};
@@ -1,4 +1,6 @@
 #include "embeddedpython.h"
+#include "processrunner.h"
+#include "pythonworker.h"
 #include <QApplication>
 #include <QMessageBox>
 #include <QNetworkRequest>
@@ -13,6 +15,7 @@
 #include <QSysInfo>
 #include <QDateTime>
 #include <QThread>
+#include <QJsonObject>
 
 // Python distribution URLs (using Python 3.11 embedded)
 const QString EmbeddedPython::PYTHON_WINDOWS_X64_URL = "https://www.python.org/ftp/python/3.11.9/python-3.11.9-embed-win32.zip";
@@ -27,7 +30,6 @@ EmbeddedPython::EmbeddedPython(QWidget* parent)
     , m_networkManager(nullptr)
     , m_currentReply(nullptr)
     , m_progressDialog(nullptr)
-    , m_currentProcess(nullptr)
     , m_setupComplete(false)
 {
     m_networkManager = new QNetworkAccessManager(this);
@@ -40,11 +42,6 @@ EmbeddedPython::~EmbeddedPython()
         m_currentReply->deleteLater();
     }
     
-    if (m_currentProcess) {
-        m_currentProcess->kill();
-        m_currentProcess->deleteLater();
-    }
-    
     if (m_progressDialog) {
         m_progressDialog->deleteLater();
     }
@@ -125,12 +122,58 @@ bool EmbeddedPython::isEmbeddedPythonAvailable()
         return false;
     }
     
-    // Test if it actually runs
-    QProcess testProcess;
-    testProcess.start(pythonExe, {"--version"});
-    testProcess.waitForFinished(5000);
-    
-    return testProcess.exitCode() == 0;
+    // Test if it actually runs; this also warms up the shared worker that
+    // later package probes and script runs reuse
+    return PythonWorker::instance().ping(pythonExe);
+}
+
+QStringList EmbeddedPython::requiredPackages()
+{
+    // Based on LVGL prerequisites-pip.txt
+    return {"Pillow", "pypng", "lz4", "kconfiglib"};
+}
+
+QString EmbeddedPython::importNameForPackage(const QString& packageName)
+{
+    if (packageName == "Pillow") {
+        return "PIL.Image";
+    } else if (packageName == "lz4") {
+        return "lz4.block";
+    } else if (packageName == "pypng") {
+        return "png";
+    }
+    return packageName;
+}
+
+QStringList EmbeddedPython::findMissingPackages(const QStringList& packages)
+{
+    QStringList modules;
+    for (const QString& package : packages) {
+        modules.append(importNameForPackage(package));
+    }
+
+    // One round trip to the worker instead of one interpreter per package
+    const QJsonObject failed = PythonWorker::instance().probeImports(getEmbeddedPythonPath(), modules);
+
+    QStringList missing;
+    for (int i = 0; i < packages.size(); ++i) {
+        if (failed.contains(modules[i])) {
+            qDebug() << "Missing Python package:" << packages[i] << failed.value(modules[i]).toString();
+            missing.append(packages[i]);
+        }
+    }
+    return missing;
+}
+
+void EmbeddedPython::logPackageVersions(const QStringList& packages)
+{
+    const QJsonObject versions = PythonWorker::instance().versions(getEmbeddedPythonPath(), packages);
+    qDebug() << "Embedded Python" << versions.value("python").toString();
+
+    const QJsonObject packageVersions = versions.value("packages").toObject();
+    for (const QString& package : packages) {
+        qDebug() << "  " << package << packageVersions.value(package).toString("not installed");
+    }
 }
 
 bool EmbeddedPython::setupEmbeddedPython()
@@ -162,10 +205,9 @@ bool EmbeddedPython::setupEmbeddedPython()
     }
     
     // Install required packages (based on LVGL prerequisites-pip.txt)
-    QStringList requiredPackages = {"Pillow", "pypng", "lz4", "kconfiglib"};
     QStringList failedPackages;
     
-    for (const QString& package : requiredPackages) {
+    for (const QString& package : requiredPackages()) {
         if (!installPackage(package)) {
             failedPackages.append(package);
         }
@@ -465,6 +507,10 @@ bool EmbeddedPython::installPip()
             qDebug() << "get-pip.py stdout:" << stdOut;
             qDebug() << "get-pip.py stderr:" << stdErr;
 
+            // site-packages may have just been enabled; make the worker
+            // pick up the new environment on its next request
+            PythonWorker::instance().shutdown();
+
             if (exitCode == 0) {
                 qDebug() << "Pip installed successfully";
             } else {
@@ -504,17 +550,23 @@ bool EmbeddedPython::installPackage(const QString& packageName)
     
     qDebug() << "Installing package:" << packageName << "with command:" << pythonExe << arguments.join(" ");
     
-    m_currentProcess = new QProcess(this);
-    connect(m_currentProcess, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
-            this, &EmbeddedPython::onProcessFinished);
-    
-    m_currentProcess->start(pythonExe, arguments);
+    // pip's output is streamed into the dialog, so a slow download shows
+    // what it is doing; one that stalls is stopped instead of hanging setup
+    ProcessRunner runner;
+    runner.setTimeouts(600000, 120000);
+    connect(&runner, &ProcessRunner::lineReceived, this,
+            [this](const QString& line, bool isError) {
+                qDebug().noquote() << "pip:" << line;
+                if (!isError && m_progressDialog) {
+                    m_progressDialog->setLabelText(line.trimmed().left(100));
+                }
+            });
     
     QEventLoop loop;
-    connect(m_currentProcess, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
-            &loop, &QEventLoop::quit);
-    connect(m_progressDialog, &QProgressDialog::canceled, &loop, &QEventLoop::quit);
+    connect(&runner, &ProcessRunner::finished, &loop, &QEventLoop::quit);
+    connect(m_progressDialog, &QProgressDialog::canceled, &runner, &ProcessRunner::cancel);
     
+    runner.start(pythonExe, arguments);
     loop.exec();
     
     if (m_progressDialog) {
@@ -523,22 +575,19 @@ bool EmbeddedPython::installPackage(const QString& packageName)
         m_progressDialog = nullptr;
     }
     
-    bool success = m_currentProcess->exitCode() == 0;
+    const ProcessRunner::Result& result = runner.result();
+    bool success = result.succeeded();
     
     if (!success) {
-        QString error = m_currentProcess->readAllStandardError();
-        QString output = m_currentProcess->readAllStandardOutput();
         qDebug() << "Package installation failed for" << packageName;
-        qDebug() << "Exit code:" << m_currentProcess->exitCode();
-        qDebug() << "Error:" << error;
-        qDebug() << "Output:" << output;
+        qDebug() << "Exit code:" << result.exitCode << result.errorString;
+        qDebug() << "Error:" << result.errorOutput;
     } else {
-        qDebug() << "Successfully installed:" << packageName;
+        qDebug() << "Successfully installed:" << packageName << "in" << result.milliseconds << "ms";
+        // Restart the worker so already-imported modules are not stale
+        PythonWorker::instance().shutdown();
     }
     
-    m_currentProcess->deleteLater();
-    m_currentProcess = nullptr;
-    
     return success;
 }
 
@@ -546,27 +595,21 @@ bool EmbeddedPython::runScript(const QString& scriptPath, const QStringList& arg
 {
     QString pythonExe = getEmbeddedPythonPath();
     
-    QStringList fullArgs;
-    fullArgs << scriptPath << arguments;
-    
     qDebug() << "Executing Python script:";
     qDebug() << "  Python executable:" << pythonExe;
     qDebug() << "  Script path:" << scriptPath;
     qDebug() << "  Arguments:" << arguments;
-    qDebug() << "  Full command:" << pythonExe << fullArgs.join(" ");
-    
-    QProcess process;
-    process.start(pythonExe, fullArgs);
-    process.waitForFinished(30000); // 30 second timeout
     
-    output = process.readAllStandardOutput();
-    error = process.readAllStandardError();
+    // Runs inside the persistent worker, so the interpreter and the
+    // Pillow/pypng/lz4 imports are paid for only once
+    bool success = PythonWorker::instance().runScript(pythonExe, scriptPath, arguments,
+                                                      output, error, 30000);
     
-    qDebug() << "Process exit code:" << process.exitCode();
-    qDebug() << "Process stdout:" << output;
-    qDebug() << "Process stderr:" << error;
+    qDebug() << "Script succeeded:" << success;
+    qDebug() << "Script stdout:" << output;
+    qDebug() << "Script stderr:" << error;
     
-    return process.exitCode() == 0;
+    return success;
 }
 
 bool EmbeddedPython::verifyInstallation()
@@ -574,32 +617,15 @@ bool EmbeddedPython::verifyInstallation()
     QString pythonExe = getEmbeddedPythonPath();
     
     // Test basic Python execution
-    QProcess testProcess;
-    testProcess.start(pythonExe, {"--version"});
-    testProcess.waitForFinished(5000);
-    
-    if (testProcess.exitCode() != 0) {
+    if (!PythonWorker::instance().ping(pythonExe)) {
         return false;
     }
     
     // Test required packages (matching LVGL script requirements)
-    QStringList testCommands = {
-        "import PIL.Image; print('Pillow OK')",
-        "import png; print('pypng OK')",
-        "import lz4.block; print('lz4 OK')",
-        "import kconfiglib; print('kconfiglib OK')"
-    };
-    
-    for (const QString& testCommand : testCommands) {
-        testProcess.start(pythonExe, {"-c", testCommand});
-        testProcess.waitForFinished(5000);
-        
-        if (testProcess.exitCode() != 0) {
-            QString error = testProcess.readAllStandardError();
-            qDebug() << "Package verification failed:" << testCommand;
-            qDebug() << "Error:" << error;
-            return false;
-        }
+    QStringList missingPackages = findMissingPackages(requiredPackages());
+    if (!missingPackages.isEmpty()) {
+        qDebug() << "Package verification failed:" << missingPackages.join(", ");
+        return false;
     }
     
     return true;
@@ -635,14 +661,4 @@ void EmbeddedPython::onDownloadError(QNetworkReply::NetworkError error)
     if (m_progressDialog) {
         m_progressDialog->close();
     }
-}
-
-void EmbeddedPython::onProcessFinished(int exitCode, QProcess::ExitStatus exitStatus)
-{
-    Q_UNUSED(exitStatus)
-    qDebug() << "Process finished with exit code:" << exitCode;
-    if (exitCode != 0 && m_currentProcess) {
-        QString error = m_currentProcess->readAllStandardError();
-        qDebug() << "Process error:" << error;
-    }
 }
\ No newline at end of file
@@ -31,6 +31,11 @@ public:
     QString getEmbeddedPythonPath();
     bool installPackage(const QString& packageName);
     bool runScript(const QString& scriptPath, const QStringList& arguments, QString& output, QString& error);
+    QStringList findMissingPackages(const QStringList& packages);
+    void logPackageVersions(const QStringList& packages);
+
+    static QStringList requiredPackages();
+    static QString importNameForPackage(const QString& packageName);
     
     // Platform-specific distributions
     static PythonDistribution getDistributionForPlatform();
@@ -39,7 +44,6 @@ private slots:
     void onDownloadProgress(qint64 bytesReceived, qint64 bytesTotal);
     void onDownloadFinished();
     void onDownloadError(QNetworkReply::NetworkError error);
-    void onProcessFinished(int exitCode, QProcess::ExitStatus exitStatus);
 
 private:
     bool downloadPythonDistribution();
@@ -53,7 +57,6 @@ private:
     QNetworkAccessManager* m_networkManager;
     QNetworkReply* m_currentReply;
     QProgressDialog* m_progressDialog;
-    QProcess* m_currentProcess;
     QString m_tempFilePath;
     QString m_currentOperation;
     bool m_setupComplete;
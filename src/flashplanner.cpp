@@ -0,0 +1,120 @@
+#include "flashplanner.h"
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QSet>
+#include <algorithm>
+#include <iterator>
+
+qint64 FlashPlanner::imageBytes(const QString &path,
+                                const LVGLImageConverter::Options &options,
+                                QString &error) {
+  const QString file = fileKey(path);
+  const QByteArray fingerprint = LVGLImageConverter::fingerprint(options);
+
+  QHash<QByteArray, qint64> &results = m_bytes[file];
+  const auto cached = results.constFind(fingerprint);
+  if (cached != results.constEnd()) {
+    return cached.value();
+  }
+
+  auto decoded = m_decoded.find(file);
+  if (decoded == m_decoded.end()) {
+    QImage image(path);
+    if (image.isNull()) {
+      error = QString("Failed to load image: %1").arg(path);
+      return -1;
+    }
+    decoded = m_decoded.insert(file, image);
+  }
+
+  LVGLImageConverter::EncodedImage encoded;
+  if (!LVGLImageConverter::encode(decoded.value(), options, encoded, error)) {
+    return -1;
+  }
+  const qint64 bytes = deviceBytes(encoded, options);
+  results.insert(fingerprint, bytes);
+  return bytes;
+}
+
+void FlashPlanner::retain(const QStringList &paths) {
+  QSet<QString> current;
+  for (const QString &path : paths) {
+    current.insert(fileKey(path));
+  }
+  for (auto it = m_decoded.begin(); it != m_decoded.end();) {
+    it = current.contains(it.key()) ? std::next(it) : m_decoded.erase(it);
+  }
+  for (auto it = m_bytes.begin(); it != m_bytes.end();) {
+    it = current.contains(it.key()) ? std::next(it) : m_bytes.erase(it);
+  }
+}
+
+QString FlashPlanner::fileKey(const QString &path) {
+  const QFileInfo info(path);
+  return info.absoluteFilePath() + '|' +
+         QString::number(info.lastModified().toMSecsSinceEpoch());
+}
+
+qint64 FlashPlanner::deviceBytes(
+    const LVGLImageConverter::EncodedImage &encoded,
+    const LVGLImageConverter::Options &options) {
+  // Arrays start on the requested alignment, and never below the word
+  // alignment the blob output uses, so count the padding in front of each
+  const qint64 alignment = std::max(4, options.alignment);
+  const qint64 padded =
+      (encoded.data.size() + alignment - 1) / alignment * alignment;
+  return padded + kDescriptorBytes;
+}
+
+qint64 FlashPlanner::hexFlashBytes(const QString &path, QString &error) {
+  QFile file(path);
+  if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+    error = QString("Could not open %1: %2").arg(path, file.errorString());
+    return -1;
+  }
+
+  // ":LLAAAATT<data>CC" - byte count, 16-bit address, record type
+  const qint64 codeFlashEnd = 0x10000000;
+  qint64 base = 0;
+  qint64 bytes = 0;
+  while (!file.atEnd()) {
+    const QByteArray line = file.readLine().trimmed();
+    if (line.isEmpty()) {
+      continue;
+    }
+    bool countOk = false;
+    bool addressOk = false;
+    bool typeOk = false;
+    const int count = line.mid(1, 2).toInt(&countOk, 16);
+    const qint64 address = line.mid(3, 4).toLongLong(&addressOk, 16);
+    const int type = line.mid(7, 2).toInt(&typeOk, 16);
+    if (!line.startsWith(':') || !countOk || !addressOk || !typeOk ||
+        line.size() < 11 + 2 * count) {
+      error = QString("%1 is not a valid Intel HEX file").arg(path);
+      return -1;
+    }
+    switch (type) {
+    case 0x00:
+      if (base + address < codeFlashEnd) {
+        bytes += count;
+      }
+      break;
+    case 0x02:
+      // Extended segment address
+      base = line.mid(9, 4).toLongLong(nullptr, 16) << 4;
+      break;
+    case 0x04:
+      // Extended linear address
+      base = line.mid(9, 4).toLongLong(nullptr, 16) << 16;
+      break;
+    default:
+      break;
+    }
+  }
+  return bytes;
+}
+
+QString FlashPlanner::formatBytes(qint64 bytes) {
+  return QString("%1 KB").arg(bytes / 1024.0, 0, 'f', 1);
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "lvglimageconverter.h"
+#include <QByteArray>
+#include <QHash>
+#include <QImage>
+#include <QString>
+#include <QStringList>
+
+// Estimates the nRF52 flash each image takes once converted, so images are
+// admitted against a flash budget rather than a fixed count.
+//
+// The estimate is what the image costs stored on its own: its encoded data
+// padded to the array alignment plus its descriptor. Tiled output and
+// deduplicated images only make the real build smaller.
+class FlashPlanner {
+public:
+  // lv_image_dsc_t on a 32-bit target plus its entry in images[]
+  static const qint64 kDescriptorBytes = 32;
+
+  // Device bytes for the image at `path` converted with `options`, or -1 with
+  // `error` set. Decoded images and results are cached until the file
+  // changes, so re-planning after an option change only re-encodes.
+  qint64 imageBytes(const QString &path,
+                    const LVGLImageConverter::Options &options,
+                    QString &error);
+  // Drops what is cached for any file not in `paths`, and for earlier
+  // versions of those that changed since
+  void retain(const QStringList &paths);
+
+  static qint64 deviceBytes(const LVGLImageConverter::EncodedImage &encoded,
+                            const LVGLImageConverter::Options &options);
+  // Bytes of code flash the Intel HEX file at `path` programs, or -1 with
+  // `error` set. UICR and other records at or above 0x10000000 are not
+  // counted.
+  static qint64 hexFlashBytes(const QString &path, QString &error);
+  // "12.3 KB", in KiB like the rest of the UI
+  static QString formatBytes(qint64 bytes);
+
+private:
+  // Absolute path and modification time
+  static QString fileKey(const QString &path);
+
+  QHash<QString, QImage> m_decoded;
+  // By file key, then by options fingerprint
+  QHash<QString, QHash<QByteArray, qint64>> m_bytes;
+};
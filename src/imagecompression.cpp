@@ -0,0 +1,160 @@
+#include "imagecompression.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+// RLE control bytes hold at most 127 blocks either way
+const size_t kMaxRun = 127;
+
+// LZ4 block format limits (lz4_Block_format.md): matches are at least four
+// bytes, the last five bytes are always literals and the last match must
+// start at least twelve bytes before the end.
+const size_t kMinMatch = 4;
+const size_t kLastLiterals = 5;
+const size_t kMatchFindLimit = 12;
+const size_t kMaxOffset = 65535;
+const int kHashBits = 14;
+
+size_t repeatCount(const uint8_t *p, size_t blocksLeft, int blockSize) {
+  size_t n = 1;
+  while (n < blocksLeft && n < kMaxRun &&
+         std::memcmp(p, p + n * blockSize, blockSize) == 0) {
+    ++n;
+  }
+  return n;
+}
+
+// Blocks to emit verbatim before the next run worth encoding as a repeat
+size_t literalCount(const uint8_t *p, size_t blocksLeft, int blockSize,
+                    size_t threshold) {
+  size_t n = 1;
+  while (n < blocksLeft && n < kMaxRun &&
+         repeatCount(p + n * blockSize, blocksLeft - n, blockSize) <
+             threshold) {
+    ++n;
+  }
+  return n;
+}
+
+inline uint32_t read32(const uint8_t *p) {
+  uint32_t v;
+  std::memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+inline uint32_t hash32(uint32_t v) {
+  return (v * 2654435761u) >> (32 - kHashBits);
+}
+
+// Lengths of 15 and up spill into extra bytes of 255 plus a remainder
+void writeLength(std::vector<uint8_t> &out, size_t length) {
+  while (length >= 255) {
+    out.push_back(255);
+    length -= 255;
+  }
+  out.push_back(uint8_t(length));
+}
+
+void writeSequence(std::vector<uint8_t> &out, const uint8_t *literals,
+                   size_t literalLength, size_t offset, size_t matchLength) {
+  const size_t matchCode = matchLength ? matchLength - kMinMatch : 0;
+  out.push_back(uint8_t((std::min<size_t>(literalLength, 15) << 4) |
+                        std::min<size_t>(matchCode, 15)));
+  if (literalLength >= 15) {
+    writeLength(out, literalLength - 15);
+  }
+  out.insert(out.end(), literals, literals + literalLength);
+  if (matchLength == 0) {
+    return; // Final literal-only sequence
+  }
+  out.push_back(uint8_t(offset & 0xff));
+  out.push_back(uint8_t(offset >> 8));
+  if (matchCode >= 15) {
+    writeLength(out, matchCode - 15);
+  }
+}
+
+} // namespace
+
+namespace ImageCompression {
+
+std::vector<uint8_t> rleCompress(const uint8_t *data, size_t size,
+                                 int blockSize) {
+  // A repeat costs the control byte plus one block, so for pixel-sized
+  // blocks even a pair of equal pixels is worth encoding as a run.
+  const size_t threshold = blockSize >= 2 ? 2 : 3;
+  const size_t blocks = size / blockSize;
+
+  std::vector<uint8_t> out;
+  out.reserve(size / 4);
+  size_t i = 0;
+  while (i < blocks) {
+    const uint8_t *p = data + i * blockSize;
+    const size_t repeats = repeatCount(p, blocks - i, blockSize);
+    if (repeats >= threshold) {
+      out.push_back(uint8_t(repeats));
+      out.insert(out.end(), p, p + blockSize);
+      i += repeats;
+    } else {
+      const size_t literals = literalCount(p, blocks - i, blockSize, threshold);
+      out.push_back(uint8_t(0x80 | literals));
+      out.insert(out.end(), p, p + literals * blockSize);
+      i += literals;
+    }
+  }
+  return out;
+}
+
+std::vector<uint8_t> lz4Compress(const uint8_t *data, size_t size) {
+  std::vector<uint8_t> out;
+  out.reserve(size / 4 + 16);
+
+  size_t anchor = 0;
+  if (size > kMatchFindLimit) {
+    std::vector<int64_t> table(size_t(1) << kHashBits, -1);
+    const size_t matchStartLimit = size - kMatchFindLimit;
+    const size_t matchEndLimit = size - kLastLiterals;
+
+    size_t ip = 0;
+    while (ip <= matchStartLimit) {
+      const uint32_t sequence = read32(data + ip);
+      const uint32_t h = hash32(sequence);
+      const int64_t candidate = table[h];
+      table[h] = int64_t(ip);
+
+      if (candidate < 0 || ip - size_t(candidate) > kMaxOffset ||
+          read32(data + candidate) != sequence) {
+        ++ip;
+        continue;
+      }
+
+      size_t ref = size_t(candidate);
+      size_t start = ip;
+      // Extend backwards into the pending literals
+      while (start > anchor && ref > 0 && data[start - 1] == data[ref - 1]) {
+        --start;
+        --ref;
+      }
+      size_t end = ip + kMinMatch;
+      while (end < matchEndLimit && data[end] == data[ref + (end - start)]) {
+        ++end;
+      }
+
+      writeSequence(out, data + anchor, start - anchor, start - ref,
+                    end - start);
+      anchor = end;
+      ip = end;
+      // Seed the table inside the match so the next search has a candidate
+      if (ip - 2 <= matchStartLimit) {
+        table[hash32(read32(data + ip - 2))] = int64_t(ip - 2);
+      }
+    }
+  }
+
+  writeSequence(out, data + anchor, size - anchor, 0, 0);
+  return out;
+}
+
+} // namespace ImageCompression
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Encoders for the two compressed image payloads LVGL 9 can decode
+// (lv_rle.c and its bundled LZ4). Both return the bare compressed stream;
+// the lv_image_compressed_t header is added by LVGLImageConverter.
+namespace ImageCompression {
+
+// LVGL RLE: a control byte with the high bit set is followed by
+// (ctrl & 0x7f) literal blocks, otherwise the next block is repeated `ctrl`
+// times. `blockSize` is the pixel size in bytes and must divide `size`.
+std::vector<uint8_t> rleCompress(const uint8_t *data, size_t size,
+                                 int blockSize);
+
+// LZ4 block format, decodable with LZ4_decompress_safe(). Greedy
+// single-probe matcher: far from lz4hc ratios, but flat UI screens are
+// dominated by long runs that it catches anyway.
+std::vector<uint8_t> lz4Compress(const uint8_t *data, size_t size);
+
+} // namespace ImageCompression
@@ -21,7 +21,7 @@ ImageDropWidget::ImageDropWidget(MainWindow* parent)
         "  background-color: #e6f3ff;"
         "}"
     );
-    setText("Drag and drop images here\n(Max 10 images, 170x320 pixels only)");
+    setText("Drag and drop images here\n(fitted to 170x320, as many as the flash budget holds)");
     setAlignment(Qt::AlignCenter);
     setMinimumSize(400, 150);
 }
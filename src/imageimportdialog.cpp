@@ -0,0 +1,204 @@
+#include "imageimportdialog.h"
+#include <QComboBox>
+#include <QDialogButtonBox>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QFormLayout>
+#include <QLabel>
+#include <QPixmap>
+#include <QPushButton>
+#include <QSettings>
+#include <QVBoxLayout>
+#include <QtConcurrent/QtConcurrent>
+#include <algorithm>
+#include <cmath>
+
+ImageImportDialog::ImageImportDialog(const QString &imagePath,
+                                     const QSize &targetSize, QWidget *parent)
+    : QDialog(parent), m_imagePath(imagePath), m_targetSize(targetSize) {
+  setWindowTitle(QString("Fit %1 to %2x%3")
+                     .arg(QFileInfo(imagePath).fileName())
+                     .arg(targetSize.width())
+                     .arg(targetSize.height()));
+
+  auto layout = new QVBoxLayout(this);
+  auto form = new QFormLayout;
+
+  QSettings settings;
+  m_fitCombo = new QComboBox;
+  m_fitCombo->addItem("Crop to fill", static_cast<int>(FitMode::Crop));
+  m_fitCombo->addItem("Letterbox", static_cast<int>(FitMode::Letterbox));
+  m_fitCombo->addItem("Stretch", static_cast<int>(FitMode::Stretch));
+  m_fitCombo->setCurrentIndex(std::max(
+      0, m_fitCombo->findData(settings.value("import/fit", 0).toInt())));
+  form->addRow("Fit:", m_fitCombo);
+
+  m_filterCombo = new QComboBox;
+  m_filterCombo->addItem(
+      "Lanczos (sharpest)",
+      static_cast<int>(ImageResampler::Filter::Lanczos3));
+  m_filterCombo->addItem("Bicubic (softer)",
+                         static_cast<int>(ImageResampler::Filter::Bicubic));
+  m_filterCombo->setCurrentIndex(std::max(
+      0, m_filterCombo->findData(settings.value("import/filter", 1).toInt())));
+  form->addRow("Filter:", m_filterCombo);
+  layout->addLayout(form);
+
+  m_previewLabel = new QLabel("Loading...");
+  m_previewLabel->setFixedSize(targetSize);
+  m_previewLabel->setAlignment(Qt::AlignCenter);
+  m_previewLabel->setStyleSheet("background-color: #404040; color: white;");
+  layout->addWidget(m_previewLabel, 0, Qt::AlignHCenter);
+
+  m_infoLabel = new QLabel;
+  m_infoLabel->setAlignment(Qt::AlignCenter);
+  m_infoLabel->setStyleSheet("color: #666; font-size: 11px;");
+  layout->addWidget(m_infoLabel);
+
+  m_buttons =
+      new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel);
+  m_buttons->button(QDialogButtonBox::Ok)->setText("Import");
+  m_buttons->button(QDialogButtonBox::Ok)->setEnabled(false);
+  connect(m_buttons, &QDialogButtonBox::accepted, this, &QDialog::accept);
+  connect(m_buttons, &QDialogButtonBox::rejected, this, &QDialog::reject);
+  layout->addWidget(m_buttons);
+
+  m_fitWatcher = new QFutureWatcher<FitResult>(this);
+  connect(m_fitWatcher, &QFutureWatcher<FitResult>::finished, this,
+          &ImageImportDialog::onFitFinished);
+  connect(m_fitCombo, QOverload<int>::of(&QComboBox::currentIndexChanged),
+          this, &ImageImportDialog::onOptionsChanged);
+  connect(m_filterCombo, QOverload<int>::of(&QComboBox::currentIndexChanged),
+          this, &ImageImportDialog::onOptionsChanged);
+
+  startFit();
+}
+
+ImageImportDialog::~ImageImportDialog() { m_fitWatcher->waitForFinished(); }
+
+void ImageImportDialog::startFit() {
+  if (m_fitWatcher->isRunning()) {
+    m_fitPending = true;
+    return;
+  }
+  m_buttons->button(QDialogButtonBox::Ok)->setEnabled(false);
+
+  const QString path = m_imagePath;
+  const QImage source = m_source;
+  const QSize target = m_targetSize;
+  const auto mode = static_cast<FitMode>(m_fitCombo->currentData().toInt());
+  const auto filter =
+      static_cast<ImageResampler::Filter>(m_filterCombo->currentData().toInt());
+
+  // Decoding a large source is as slow as fitting it, so that happens on the
+  // worker too, once; later runs reuse the decoded image.
+  m_fitWatcher->setFuture(
+      QtConcurrent::run([path, source, target, mode, filter]() {
+        FitResult result;
+        result.source = source.isNull() ? QImage(path) : source;
+        QElapsedTimer timer;
+        timer.start();
+        result.image = fit(result.source, target, mode, filter);
+        result.milliseconds = timer.elapsed();
+        return result;
+      }));
+}
+
+void ImageImportDialog::onFitFinished() {
+  const FitResult result = m_fitWatcher->result();
+  m_source = result.source;
+  m_result = result.image;
+
+  if (m_source.isNull()) {
+    m_previewLabel->setText("Failed to load image");
+    m_infoLabel->setText(m_imagePath);
+    return;
+  }
+
+  if (m_fitPending) {
+    m_fitPending = false;
+    startFit();
+    return;
+  }
+
+  m_previewLabel->setPixmap(QPixmap::fromImage(m_result));
+  m_infoLabel->setText(QString("%1x%2 → %3x%4, %5 ms")
+                           .arg(m_source.width())
+                           .arg(m_source.height())
+                           .arg(m_targetSize.width())
+                           .arg(m_targetSize.height())
+                           .arg(result.milliseconds));
+  m_buttons->button(QDialogButtonBox::Ok)->setEnabled(true);
+}
+
+void ImageImportDialog::onOptionsChanged() {
+  QSettings settings;
+  settings.setValue("import/fit", m_fitCombo->currentData().toInt());
+  settings.setValue("import/filter", m_filterCombo->currentData().toInt());
+  startFit();
+}
+
+QImage ImageImportDialog::fit(const QImage &source, const QSize &targetSize,
+                              FitMode mode, ImageResampler::Filter filter) {
+  if (source.isNull() || targetSize.isEmpty()) {
+    return QImage();
+  }
+
+  // Premultiplied, so transparent pixels do not bleed their color into the
+  // edges of what they surround
+  const QImage src =
+      source.convertToFormat(QImage::Format_RGBA8888_Premultiplied);
+  QImage out(targetSize, QImage::Format_RGBA8888_Premultiplied);
+  out.fill(Qt::black);
+
+  const int sw = src.width();
+  const int sh = src.height();
+  const int tw = targetSize.width();
+  const int th = targetSize.height();
+  const double scaleX = double(tw) / sw;
+  const double scaleY = double(th) / sh;
+
+  switch (mode) {
+  case FitMode::Crop: {
+    // Resample only the centered part of the source that covers the panel
+    const double scale = std::max(scaleX, scaleY);
+    const int cw = qBound(1, int(std::lround(tw / scale)), sw);
+    const int ch = qBound(1, int(std::lround(th / scale)), sh);
+    const uchar *origin = src.constBits() + size_t((sh - ch) / 2) *
+                                                src.bytesPerLine() +
+                          size_t((sw - cw) / 2) * 4;
+    ImageResampler::resize(origin, cw, ch, int(src.bytesPerLine()),
+                           out.bits(), tw, th, int(out.bytesPerLine()), filter);
+    break;
+  }
+  case FitMode::Letterbox: {
+    // Resample straight into the centered window; the bars stay black
+    const double scale = std::min(scaleX, scaleY);
+    const int fw = qBound(1, int(std::lround(sw * scale)), tw);
+    const int fh = qBound(1, int(std::lround(sh * scale)), th);
+    uchar *origin = out.bits() + size_t((th - fh) / 2) * out.bytesPerLine() +
+                    size_t((tw - fw) / 2) * 4;
+    ImageResampler::resize(src.constBits(), sw, sh, int(src.bytesPerLine()),
+                           origin, fw, fh, int(out.bytesPerLine()), filter);
+    break;
+  }
+  case FitMode::Stretch:
+    ImageResampler::resize(src.constBits(), sw, sh, int(src.bytesPerLine()),
+                           out.bits(), tw, th, int(out.bytesPerLine()), filter);
+    break;
+  }
+
+  // Negative filter lobes can ring a channel above its alpha, which is not a
+  // valid premultiplied pixel
+  if (source.hasAlphaChannel()) {
+    for (int y = 0; y < th; ++y) {
+      uchar *p = out.scanLine(y);
+      for (int x = 0; x < tw; ++x, p += 4) {
+        p[0] = std::min(p[0], p[3]);
+        p[1] = std::min(p[1], p[3]);
+        p[2] = std::min(p[2], p[3]);
+      }
+    }
+  }
+  return out.convertToFormat(QImage::Format_RGBA8888);
+}
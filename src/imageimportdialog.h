@@ -0,0 +1,59 @@
+#pragma once
+
+#include "imageresampler.h"
+#include <QDialog>
+#include <QFutureWatcher>
+#include <QImage>
+#include <QSize>
+
+class QComboBox;
+class QDialogButtonBox;
+class QLabel;
+
+// Shown when an added image is not panel-sized. Fits it to the panel on a
+// worker thread and previews the result; the caller saves result() once the
+// user accepts.
+class ImageImportDialog : public QDialog {
+  Q_OBJECT
+
+public:
+  // Crop fills the panel and trims the overflow, Letterbox keeps the whole
+  // image and pads with black, Stretch ignores the aspect ratio.
+  enum class FitMode { Crop, Letterbox, Stretch };
+
+  ImageImportDialog(const QString &imagePath, const QSize &targetSize,
+                    QWidget *parent = nullptr);
+  ~ImageImportDialog();
+
+  QImage result() const { return m_result; }
+
+  // Resamples `source` to exactly `targetSize`. Safe to call off the GUI
+  // thread; returns a null image when `source` is null.
+  static QImage fit(const QImage &source, const QSize &targetSize,
+                    FitMode mode, ImageResampler::Filter filter);
+
+private:
+  struct FitResult {
+    QImage source;
+    QImage image;
+    qint64 milliseconds = 0;
+  };
+
+  void startFit();
+  void onFitFinished();
+  void onOptionsChanged();
+
+  QString m_imagePath;
+  QSize m_targetSize;
+  QImage m_source;
+  QImage m_result;
+  // An option changed while a fit was running; rerun when it finishes
+  bool m_fitPending = false;
+
+  QComboBox *m_fitCombo;
+  QComboBox *m_filterCombo;
+  QLabel *m_previewLabel;
+  QLabel *m_infoLabel;
+  QDialogButtonBox *m_buttons;
+  QFutureWatcher<FitResult> *m_fitWatcher;
+};
@@ -3,7 +3,10 @@
 #include <QPixmap>
 #include <QFileInfo>
 
-ImagePreviewWidget::ImagePreviewWidget(const QString& imagePath, int index, MainWindow* parent)
+ImagePreviewWidget::ImagePreviewWidget(const QString& imagePath, int index,
+                                       LVGLImageConverter::ColorFormat colorFormat,
+                                       LVGLImageConverter::Compression compression,
+                                       MainWindow* parent)
     : QFrame(parent), m_imagePath(imagePath), m_index(index), m_parentWindow(parent)
 {
     setFrameStyle(QFrame::Box);
@@ -31,6 +34,39 @@ ImagePreviewWidget::ImagePreviewWidget(const QString& imagePath, int index, Main
     m_infoLabel->setAlignment(Qt::AlignCenter);
     m_infoLabel->setStyleSheet("font-size: 10px; color: #666;");
     
+    // Color format on the device; smaller formats mean less flash to write
+    m_colorFormatCombo = new QComboBox;
+    for (LVGLImageConverter::ColorFormat format : LVGLImageConverter::colorFormats()) {
+        m_colorFormatCombo->addItem(
+            QString("%1 (%2 bpp)")
+                .arg(LVGLImageConverter::colorFormatName(format))
+                .arg(LVGLImageConverter::bitsPerPixel(format)),
+            static_cast<int>(format));
+    }
+    m_colorFormatCombo->setCurrentIndex(
+        m_colorFormatCombo->findData(static_cast<int>(colorFormat)));
+    m_colorFormatCombo->setToolTip(
+        "RGB565A8 keeps transparency, L8/A8 store luminance/alpha only, and "
+        "I1-I8 reduce the image to 2/4/16/256 colors.");
+    connect(m_colorFormatCombo, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            this, &ImagePreviewWidget::onColorFormatChanged);
+
+    // Compressed images take less flash but are decoded into RAM on the device
+    m_compressionCombo = new QComboBox;
+    m_compressionCombo->addItem("Uncompressed",
+                                static_cast<int>(LVGLImageConverter::Compression::None));
+    m_compressionCombo->addItem("RLE",
+                                static_cast<int>(LVGLImageConverter::Compression::RLE));
+    m_compressionCombo->addItem("LZ4",
+                                static_cast<int>(LVGLImageConverter::Compression::LZ4));
+    m_compressionCombo->setCurrentIndex(
+        m_compressionCombo->findData(static_cast<int>(compression)));
+    m_compressionCombo->setToolTip(
+        "RLE suits flat UI graphics, LZ4 also catches repeated patterns. LVGL "
+        "decompresses the image into RAM when it is first drawn.");
+    connect(m_compressionCombo, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            this, &ImagePreviewWidget::onCompressionChanged);
+
     // Remove button
     m_removeButton = new QPushButton("Remove");
     m_removeButton->setStyleSheet(
@@ -41,6 +77,8 @@ ImagePreviewWidget::ImagePreviewWidget(const QString& imagePath, int index, Main
     
     layout->addWidget(m_imageLabel);
     layout->addWidget(m_infoLabel);
+    layout->addWidget(m_colorFormatCombo);
+    layout->addWidget(m_compressionCombo);
     layout->addWidget(m_removeButton);
 }
 
@@ -49,4 +87,24 @@ void ImagePreviewWidget::removeImage()
     if (m_parentWindow) {
         m_parentWindow->removeImage(m_index);
     }
+}
+
+void ImagePreviewWidget::onColorFormatChanged(int comboIndex)
+{
+    if (m_parentWindow) {
+        m_parentWindow->setImageColorFormat(
+            m_index,
+            static_cast<LVGLImageConverter::ColorFormat>(
+                m_colorFormatCombo->itemData(comboIndex).toInt()));
+    }
+}
+
+void ImagePreviewWidget::onCompressionChanged(int comboIndex)
+{
+    if (m_parentWindow) {
+        m_parentWindow->setImageCompression(
+            m_index,
+            static_cast<LVGLImageConverter::Compression>(
+                m_compressionCombo->itemData(comboIndex).toInt()));
+    }
 }
\ No newline at end of file
@@ -1,11 +1,13 @@
 #pragma once
 
+#include <QComboBox>
 #include <QFrame>
 #include <QLabel>
 #include <QPushButton>
 #include <QVBoxLayout>
 #include <QPixmap>
 #include <QFileInfo>
+#include "lvglimageconverter.h"
 
 class MainWindow;
 
@@ -14,10 +16,15 @@ class ImagePreviewWidget : public QFrame
     Q_OBJECT
 
 public:
-    ImagePreviewWidget(const QString& imagePath, int index, MainWindow* parent = nullptr);
+    ImagePreviewWidget(const QString& imagePath, int index,
+                       LVGLImageConverter::ColorFormat colorFormat,
+                       LVGLImageConverter::Compression compression,
+                       MainWindow* parent = nullptr);
 
 private slots:
     void removeImage();
+    void onColorFormatChanged(int comboIndex);
+    void onCompressionChanged(int comboIndex);
 
 private:
     QString m_imagePath;
@@ -26,5 +33,7 @@ private:
     
     QLabel* m_imageLabel;
     QLabel* m_infoLabel;
+    QComboBox* m_colorFormatCombo;
+    QComboBox* m_compressionCombo;
     QPushButton* m_removeButton;
 };
\ No newline at end of file
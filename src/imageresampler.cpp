@@ -0,0 +1,117 @@
+#include "imageresampler.h"
+#include "pixelkernels.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+const double kPi = 3.14159265358979323846;
+
+// Keys cubic with a = -0.5 (Catmull-Rom), the usual "bicubic"
+double bicubic(double x) {
+  const double a = -0.5;
+  x = std::fabs(x);
+  if (x < 1.0) {
+    return ((a + 2.0) * x - (a + 3.0)) * x * x + 1.0;
+  }
+  if (x < 2.0) {
+    return ((a * x - 5.0 * a) * x + 8.0 * a) * x - 4.0 * a;
+  }
+  return 0.0;
+}
+
+double sinc(double x) {
+  if (x == 0.0) {
+    return 1.0;
+  }
+  x *= kPi;
+  return std::sin(x) / x;
+}
+
+double lanczos3(double x) {
+  return std::fabs(x) < 3.0 ? sinc(x) * sinc(x / 3.0) : 0.0;
+}
+
+} // namespace
+
+namespace ImageResampler {
+
+Coefficients coefficients(int srcSize, int dstSize, Filter filter) {
+  double (*const kernel)(double) =
+      filter == Filter::Lanczos3 ? lanczos3 : bicubic;
+  const double kernelSupport = filter == Filter::Lanczos3 ? 3.0 : 2.0;
+
+  // Downscaling stretches the kernel over the source so every input pixel
+  // contributes (area-style prefiltering, no aliasing)
+  const double scale = double(srcSize) / dstSize;
+  const double filterScale = std::max(1.0, scale);
+  const double support = kernelSupport * filterScale;
+
+  Coefficients c;
+  c.taps = std::min(int(std::ceil(support)) * 2 + 1, srcSize);
+  c.starts.resize(dstSize);
+  c.weights.assign(size_t(dstSize) * c.taps, 0);
+
+  const int one = 1 << PixelKernels::kResampleWeightBits;
+  std::vector<double> window(c.taps);
+  for (int i = 0; i < dstSize; ++i) {
+    const double center = (i + 0.5) * scale;
+    const int first = std::max(0, int(center - support + 0.5));
+    const int last = std::min(srcSize, int(center + support + 0.5));
+    const int count = std::min(last - first, c.taps);
+
+    double total = 0.0;
+    for (int k = 0; k < count; ++k) {
+      window[k] = kernel((first + k - center + 0.5) / filterScale);
+      total += window[k];
+    }
+
+    // Keep the fixed window inside the source; the extra taps weigh zero
+    const int start = std::min(first, srcSize - c.taps);
+    int16_t *weights = &c.weights[size_t(i) * c.taps + (first - start)];
+    c.starts[i] = start;
+
+    // Quantize, then put the rounding error on the largest weight so each
+    // window sums to exactly 1.0 and flat areas stay flat
+    int sum = 0;
+    int largest = 0;
+    for (int k = 0; k < count; ++k) {
+      weights[k] = int16_t(std::lround(window[k] / total * one));
+      sum += weights[k];
+      if (weights[k] > weights[largest]) {
+        largest = k;
+      }
+    }
+    weights[largest] = int16_t(weights[largest] + one - sum);
+  }
+  return c;
+}
+
+void resize(const uint8_t *src, int srcWidth, int srcHeight, int srcStride,
+            uint8_t *dst, int dstWidth, int dstHeight, int dstStride,
+            Filter filter) {
+  const Coefficients horizontal = coefficients(srcWidth, dstWidth, filter);
+  const Coefficients vertical = coefficients(srcHeight, dstHeight, filter);
+
+  // Horizontal pass first: sources are usually much wider than the panel,
+  // so the intermediate image is already narrow
+  const int tmpStride = dstWidth * 4;
+  std::vector<uint8_t> tmp(size_t(tmpStride) * srcHeight);
+  for (int y = 0; y < srcHeight; ++y) {
+    PixelKernels::resampleHorizontal(src + size_t(y) * srcStride,
+                                     tmp.data() + size_t(y) * tmpStride,
+                                     dstWidth, horizontal.starts.data(),
+                                     horizontal.taps,
+                                     horizontal.weights.data());
+  }
+
+  for (int y = 0; y < dstHeight; ++y) {
+    PixelKernels::resampleVertical(
+        tmp.data() + size_t(vertical.starts[y]) * tmpStride, tmpStride,
+        vertical.taps, vertical.weights.data() + size_t(y) * vertical.taps,
+        dst + size_t(y) * dstStride, tmpStride);
+  }
+}
+
+} // namespace ImageResampler
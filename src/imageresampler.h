@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// High-quality RGBA8888 resizing for the import stage: a separable filter
+// with precomputed fixed-point weights, run through the SIMD passes in
+// PixelKernels. Feed premultiplied alpha so edges do not pick up the color
+// of transparent pixels.
+namespace ImageResampler {
+
+enum class Filter { Bicubic, Lanczos3 };
+
+// Weights mapping `srcSize` samples onto `dstSize`: output i is the sum of
+// `taps` inputs from starts[i], weighted by weights[i * taps + k]. Every
+// window lies inside the source, so kernels never read past its edge.
+struct Coefficients {
+  int taps = 0;
+  std::vector<int> starts;
+  std::vector<int16_t> weights;
+};
+
+Coefficients coefficients(int srcSize, int dstSize, Filter filter);
+
+void resize(const uint8_t *src, int srcWidth, int srcHeight, int srcStride,
+            uint8_t *dst, int dstWidth, int dstHeight, int dstStride,
+            Filter filter);
+
+} // namespace ImageResampler
@@ -1299,29 +1299,7 @@ bool LibraryChecker::isPythonPackagesPresent(QStringList& missingPackages)
         return false;
     }
 
-    QString pythonExe = m_embeddedPython->getEmbeddedPythonPath();
-    QStringList requiredPackages = {"Pillow", "pypng", "lz4", "kconfiglib"};
-
-    for (const QString& package : requiredPackages) {
-        // Test each package
-        QString testCommand;
-        if (package == "Pillow") {
-            testCommand = "import PIL.Image";
-        } else if (package == "lz4") {
-            testCommand = "import lz4.block";
-        } else {
-            testCommand = QString("import %1").arg(package == "pypng" ? "png" : package);
-        }
-
-        QProcess testProcess;
-        testProcess.start(pythonExe, {"-c", testCommand});
-        testProcess.waitForFinished(5000);
-
-        if (testProcess.exitCode() != 0) {
-            missingPackages.append(package);
-            qDebug() << "Missing Python package:" << package;
-        }
-    }
+    missingPackages = m_embeddedPython->findMissingPackages(EmbeddedPython::requiredPackages());
 
     return missingPackages.isEmpty();
 }
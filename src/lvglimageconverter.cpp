@@ -0,0 +1,668 @@
+#include "lvglimageconverter.h"
+#include "colorquantizer.h"
+#include "imagecompression.h"
+#include "pixelkernels.h"
+#include <QDataStream>
+#include <QDebug>
+#include <QFile>
+#include <QStringList>
+#include <cstring>
+
+namespace {
+// Mirrors the C template in lvgl/scripts/LVGLImage.py (LVGLImage.to_c_array)
+// so the generated sources do not change when switching between the Python
+// script and the native converter.
+const char *kCHeaderTemplate =
+    "\n"
+    "#if defined(LV_LVGL_H_INCLUDE_SIMPLE)\n"
+    "#include \"lvgl.h\"\n"
+    "#elif defined(LV_LVGL_H_INCLUDE_SIMPLE)\n"
+    "#include \"lvgl.h\"\n"
+    "#elif defined(LV_BUILD_TEST)\n"
+    "#include \"../lvgl.h\"\n"
+    "#else\n"
+    "#include \"lvgl/lvgl.h\"\n"
+    "#endif\n"
+    "\n"
+    "\n"
+    "#ifndef LV_ATTRIBUTE_MEM_ALIGN\n"
+    "#define LV_ATTRIBUTE_MEM_ALIGN\n"
+    "#endif\n"
+    "\n"
+    "#ifndef LV_ATTRIBUTE_%1\n"
+    "#define LV_ATTRIBUTE_%1%3\n"
+    "#endif\n"
+    "\n"
+    "static const\n"
+    "LV_ATTRIBUTE_MEM_ALIGN LV_ATTRIBUTE_LARGE_CONST LV_ATTRIBUTE_%1\n"
+    "uint8_t %2_map[] = {\n";
+
+const char *kDescriptorTemplate =
+    "const lv_image_dsc_t %1 = {\n"
+    "  .header = {\n"
+    "    .magic = LV_IMAGE_HEADER_MAGIC,\n"
+    "    .cf = LV_COLOR_FORMAT_%2,\n"
+    "    .flags = %3,\n"
+    "    .w = %4,\n"
+    "    .h = %5,\n"
+    "    .stride = %6,\n"
+    "    .reserved_2 = 0,\n"
+    "  },\n"
+    "  .data_size = %7,\n"
+    "  .data = %8,\n"
+    "  .reserved = NULL,\n"
+    "};\n";
+
+// Same layout as LVGLImage.py's write_binary(): one output line per `stride`
+// bytes, each byte written as "0x%02x,".
+void appendHexRows(QByteArray &out, const char *data, int size, int stride) {
+  static const char kHex[] = "0123456789abcdef";
+  if (stride <= 0) {
+    stride = 16;
+  }
+  out.reserve(out.size() + size * 5 + (size / stride + 1) * 5);
+  for (int i = 0; i < size; ++i) {
+    if (i % stride == 0) {
+      out.append("\n    ");
+    }
+    const unsigned char v = static_cast<unsigned char>(data[i]);
+    const char hex[5] = {'0', 'x', kHex[v >> 4], kHex[v & 0x0f], ','};
+    out.append(hex, 5);
+  }
+  out.append('\n');
+}
+
+typedef LVGLImageConverter::ColorFormat ColorFormat;
+typedef LVGLImageConverter::EncodedImage EncodedImage;
+
+// RGB565 rows from RGBA8888 or RGB888 source rows, with optional dithering.
+// Shared by RGB565 and the color plane of RGB565A8.
+void encodeRGB565Plane(const QImage &src, LVGLImageConverter::Dither dither,
+                       uint8_t *dst, int dstStride) {
+  const bool hasAlpha = src.format() == QImage::Format_RGBA8888;
+  const int width = src.width();
+  const int height = src.height();
+
+  if (dither == LVGLImageConverter::Dither::FloydSteinberg) {
+    PixelKernels::floydSteinbergToRgb565(src.constBits(), src.bytesPerLine(),
+                                         hasAlpha ? 4 : 3, dst, dstStride,
+                                         width, height);
+    return;
+  }
+
+  const bool ordered = dither == LVGLImageConverter::Dither::Ordered;
+  for (int y = 0; y < height; ++y) {
+    const uint8_t *row = src.constScanLine(y);
+    uint8_t *dstRow = dst + y * dstStride;
+    if (hasAlpha) {
+      if (ordered) {
+        PixelKernels::rgba8888ToRgb565Ordered(row, dstRow, width, y);
+      } else {
+        PixelKernels::rgba8888ToRgb565(row, dstRow, width);
+      }
+    } else {
+      if (ordered) {
+        PixelKernels::rgb888ToRgb565Ordered(row, dstRow, width, y);
+      } else {
+        PixelKernels::rgb888ToRgb565(row, dstRow, width);
+      }
+    }
+  }
+}
+
+bool encodeRGB565(const QImage &image,
+                  const LVGLImageConverter::Options &options,
+                  EncodedImage &out, QString &) {
+  // Alpha is dropped exactly like LVGLImage.py's RGB565 packer, which only
+  // looks at the R, G and B channels. Opaque images go through the 3-byte
+  // layout to avoid expanding them to RGBA first.
+  const QImage src = image.convertToFormat(image.hasAlphaChannel()
+                                               ? QImage::Format_RGBA8888
+                                               : QImage::Format_RGB888);
+  out.stride = out.width * 2;
+  out.data.resize(out.stride * out.height);
+  encodeRGB565Plane(src, options.dither,
+                    reinterpret_cast<uint8_t *>(out.data.data()), out.stride);
+  return true;
+}
+
+// RGB565 plane followed by an A8 plane of stride width; the header stride
+// describes the color plane.
+bool encodeRGB565A8(const QImage &image,
+                    const LVGLImageConverter::Options &options,
+                    EncodedImage &out, QString &) {
+  const QImage src = image.convertToFormat(QImage::Format_RGBA8888);
+  out.stride = out.width * 2;
+  out.data.resize((out.stride + out.width) * out.height);
+
+  uint8_t *dst = reinterpret_cast<uint8_t *>(out.data.data());
+  encodeRGB565Plane(src, options.dither, dst, out.stride);
+
+  uint8_t *alpha = dst + out.stride * out.height;
+  for (int y = 0; y < out.height; ++y) {
+    const uint8_t *row = src.constScanLine(y);
+    for (int x = 0; x < out.width; ++x) {
+      alpha[y * out.width + x] = row[4 * x + 3];
+    }
+  }
+  return true;
+}
+
+// Byte-per-channel formats. Each specialization names the QImage layout it
+// reads and packs one pixel; encodeDirect<F> instantiates the row loop per
+// format so there is no per-pixel switch.
+template <ColorFormat F> struct DirectFormat;
+
+template <> struct DirectFormat<ColorFormat::RGB888> {
+  static const QImage::Format kSource = QImage::Format_RGB888;
+  static const int kSourceBytes = 3;
+  static const int kBytes = 3;
+  // LVGL stores RGB888 as B, G, R
+  static void pack(const uint8_t *p, uint8_t *out) {
+    out[0] = p[2];
+    out[1] = p[1];
+    out[2] = p[0];
+  }
+};
+
+template <> struct DirectFormat<ColorFormat::L8> {
+  static const QImage::Format kSource = QImage::Format_RGB888;
+  static const int kSourceBytes = 3;
+  static const int kBytes = 1;
+  // ITU-R 601-2 luma, the same weights as Pillow's convert("L")
+  static void pack(const uint8_t *p, uint8_t *out) {
+    out[0] = static_cast<uint8_t>(
+        (p[0] * 19595 + p[1] * 38470 + p[2] * 7471 + 0x8000) >> 16);
+  }
+};
+
+template <> struct DirectFormat<ColorFormat::A8> {
+  static const QImage::Format kSource = QImage::Format_RGBA8888;
+  static const int kSourceBytes = 4;
+  static const int kBytes = 1;
+  static void pack(const uint8_t *p, uint8_t *out) { out[0] = p[3]; }
+};
+
+template <ColorFormat F>
+bool encodeDirect(const QImage &image, const LVGLImageConverter::Options &,
+                  EncodedImage &out, QString &) {
+  typedef DirectFormat<F> Format;
+  const QImage src = image.convertToFormat(Format::kSource);
+  out.stride = out.width * Format::kBytes;
+  out.data.resize(out.stride * out.height);
+
+  uint8_t *dst = reinterpret_cast<uint8_t *>(out.data.data());
+  for (int y = 0; y < out.height; ++y) {
+    const uint8_t *row = src.constScanLine(y);
+    uint8_t *dstRow = dst + y * out.stride;
+    for (int x = 0; x < out.width; ++x) {
+      Format::pack(row + x * Format::kSourceBytes, dstRow + x * Format::kBytes);
+    }
+  }
+  return true;
+}
+
+// I1/I2/I4/I8: a full (1 << Bits)-entry palette of B, G, R, A colors
+// followed by the index rows, packed most significant bits first. Images with
+// few enough colors get an exact palette; anything else is quantized, with
+// error diffusion when dithering is enabled (ordered dithering does not
+// apply to a palette, so it diffuses too).
+template <int Bits>
+bool encodeIndexed(const QImage &image,
+                   const LVGLImageConverter::Options &options,
+                   EncodedImage &out, QString &) {
+  const int kColors = 1 << Bits;
+  const int kPixelsPerByte = 8 / Bits;
+  const QImage src = image.convertToFormat(QImage::Format_RGBA8888);
+
+  bool exact = false;
+  const std::vector<ColorQuantizer::Color> palette =
+      ColorQuantizer::buildPalette(src.constBits(), out.width, out.height,
+                                   src.bytesPerLine(), kColors, exact);
+  // An exact palette needs no dithering. A quantized one can still come out
+  // smaller than kColors, because the colors are coarsened before the cut.
+  const bool dither =
+      options.dither != LVGLImageConverter::Dither::None && !exact;
+
+  std::vector<uint8_t> map(size_t(out.width) * out.height);
+  ColorQuantizer::mapToPalette(src.constBits(), out.width, out.height,
+                               src.bytesPerLine(), palette, dither,
+                               map.data());
+
+  out.stride = (out.width + kPixelsPerByte - 1) / kPixelsPerByte;
+  const int paletteBytes = kColors * 4;
+  out.data.fill('\0', paletteBytes + out.stride * out.height);
+
+  uint8_t *entry = reinterpret_cast<uint8_t *>(out.data.data());
+  for (const ColorQuantizer::Color &color : palette) {
+    entry[0] = color.b;
+    entry[1] = color.g;
+    entry[2] = color.r;
+    entry[3] = color.a;
+    entry += 4;
+  }
+
+  uint8_t *indices = reinterpret_cast<uint8_t *>(out.data.data()) + paletteBytes;
+  for (int y = 0; y < out.height; ++y) {
+    const uint8_t *row = map.data() + size_t(y) * out.width;
+    uint8_t *dstRow = indices + y * out.stride;
+    for (int x = 0; x < out.width; ++x) {
+      const int shift = 8 - Bits * (x % kPixelsPerByte + 1);
+      dstRow[x / kPixelsPerByte] |= static_cast<uint8_t>(row[x] << shift);
+    }
+  }
+  return true;
+}
+
+// RLE works on whole pixels where the layout allows it; planar and
+// sub-byte formats fall back to single bytes.
+int rleBlockSize(ColorFormat format) {
+  switch (format) {
+  case ColorFormat::RGB565:
+    return 2;
+  case ColorFormat::RGB888:
+    return 3;
+  default:
+    return 1;
+  }
+}
+
+// Pads every row to a multiple of `alignment` bytes so each one can be
+// handed to DMA as is. Indexed formats keep their palette in front; the
+// alpha plane of RGB565A8 follows LVGL's layout with half the color stride.
+void padRows(EncodedImage &out, int alignment) {
+  const int stride = (out.stride + alignment - 1) / alignment * alignment;
+  if (stride == out.stride) {
+    return;
+  }
+
+  int prefix = 0;
+  switch (out.colorFormat) {
+  case ColorFormat::I1:
+  case ColorFormat::I2:
+  case ColorFormat::I4:
+  case ColorFormat::I8:
+    prefix = (1 << LVGLImageConverter::bitsPerPixel(out.colorFormat)) * 4;
+    break;
+  default:
+    break;
+  }
+
+  QByteArray padded(prefix + stride * out.height, '\0');
+  std::memcpy(padded.data(), out.data.constData(), prefix);
+  for (int y = 0; y < out.height; ++y) {
+    std::memcpy(padded.data() + prefix + y * stride,
+                out.data.constData() + prefix + y * out.stride, out.stride);
+  }
+
+  if (out.colorFormat == ColorFormat::RGB565A8) {
+    const char *alpha = out.data.constData() + out.stride * out.height;
+    QByteArray alphaPlane(stride / 2 * out.height, '\0');
+    for (int y = 0; y < out.height; ++y) {
+      std::memcpy(alphaPlane.data() + y * stride / 2, alpha + y * out.width,
+                  out.width);
+    }
+    padded.append(alphaPlane);
+  }
+
+  out.stride = stride;
+  out.data = padded;
+}
+
+// Replaces the encoded pixels with an lv_image_compressed_t payload: method,
+// compressed size and decompressed size as little-endian uint32, then the
+// stream. LVGL's RLE stream starts with the block size byte it was encoded
+// with. Data that does not shrink is left uncompressed.
+void compress(EncodedImage &out, LVGLImageConverter::Compression method) {
+  const uint8_t *raw = reinterpret_cast<const uint8_t *>(out.data.constData());
+  const size_t rawSize = size_t(out.data.size());
+
+  std::vector<uint8_t> stream;
+  if (method == LVGLImageConverter::Compression::RLE) {
+    // Padded RGB888 rows no longer split into whole pixels
+    int blockSize = rleBlockSize(out.colorFormat);
+    if (rawSize % blockSize != 0) {
+      blockSize = 1;
+    }
+    stream.push_back(uint8_t(blockSize));
+    const std::vector<uint8_t> rle =
+        ImageCompression::rleCompress(raw, rawSize, blockSize);
+    stream.insert(stream.end(), rle.begin(), rle.end());
+  } else {
+    stream = ImageCompression::lz4Compress(raw, rawSize);
+  }
+
+  if (stream.size() + 12 >= rawSize) {
+    qDebug() << "Compression does not shrink the image, storing it raw";
+    return;
+  }
+
+  QByteArray payload;
+  payload.reserve(int(stream.size()) + 12);
+  const uint32_t header[3] = {uint32_t(method), uint32_t(stream.size()),
+                              uint32_t(rawSize)};
+  for (uint32_t word : header) {
+    for (int shift = 0; shift < 32; shift += 8) {
+      payload.append(char((word >> shift) & 0xff));
+    }
+  }
+  payload.append(reinterpret_cast<const char *>(stream.data()),
+                 int(stream.size()));
+
+  out.compression = method;
+  out.data = payload;
+}
+
+typedef bool (*EncodeFn)(const QImage &, const LVGLImageConverter::Options &,
+                         EncodedImage &, QString &);
+
+EncodeFn encoderFor(ColorFormat format) {
+  switch (format) {
+  case ColorFormat::RGB565:
+    return encodeRGB565;
+  case ColorFormat::RGB565A8:
+    return encodeRGB565A8;
+  case ColorFormat::RGB888:
+    return encodeDirect<ColorFormat::RGB888>;
+  case ColorFormat::L8:
+    return encodeDirect<ColorFormat::L8>;
+  case ColorFormat::A8:
+    return encodeDirect<ColorFormat::A8>;
+  case ColorFormat::I1:
+    return encodeIndexed<1>;
+  case ColorFormat::I2:
+    return encodeIndexed<2>;
+  case ColorFormat::I4:
+    return encodeIndexed<4>;
+  case ColorFormat::I8:
+    return encodeIndexed<8>;
+  }
+  return nullptr;
+}
+} // namespace
+
+const char *LVGLImageConverter::colorFormatName(ColorFormat format) {
+  switch (format) {
+  case ColorFormat::RGB565:
+    return "RGB565";
+  case ColorFormat::RGB565A8:
+    return "RGB565A8";
+  case ColorFormat::RGB888:
+    return "RGB888";
+  case ColorFormat::L8:
+    return "L8";
+  case ColorFormat::A8:
+    return "A8";
+  case ColorFormat::I1:
+    return "I1";
+  case ColorFormat::I2:
+    return "I2";
+  case ColorFormat::I4:
+    return "I4";
+  case ColorFormat::I8:
+    return "I8";
+  }
+  return "UNKNOWN";
+}
+
+QList<LVGLImageConverter::ColorFormat> LVGLImageConverter::colorFormats() {
+  return {ColorFormat::RGB565, ColorFormat::RGB565A8, ColorFormat::RGB888,
+          ColorFormat::L8,     ColorFormat::A8,       ColorFormat::I1,
+          ColorFormat::I2,     ColorFormat::I4,       ColorFormat::I8};
+}
+
+int LVGLImageConverter::bitsPerPixel(ColorFormat format) {
+  switch (format) {
+  case ColorFormat::RGB565:
+    return 16;
+  case ColorFormat::RGB565A8:
+  case ColorFormat::RGB888:
+    return 24;
+  case ColorFormat::L8:
+  case ColorFormat::A8:
+  case ColorFormat::I8:
+    return 8;
+  case ColorFormat::I1:
+    return 1;
+  case ColorFormat::I2:
+    return 2;
+  case ColorFormat::I4:
+    return 4;
+  }
+  return 0;
+}
+
+const char *LVGLImageConverter::compressionName(Compression compression) {
+  switch (compression) {
+  case Compression::None:
+    return "NONE";
+  case Compression::RLE:
+    return "RLE";
+  case Compression::LZ4:
+    return "LZ4";
+  }
+  return "UNKNOWN";
+}
+
+const char *LVGLImageConverter::ditherName(Dither dither) {
+  switch (dither) {
+  case Dither::None:
+    return "none";
+  case Dither::Ordered:
+    return "ordered";
+  case Dither::FloydSteinberg:
+    return "floyd-steinberg";
+  }
+  return "unknown";
+}
+
+bool LVGLImageConverter::encode(const QImage &image, const Options &options,
+                                EncodedImage &encoded, QString &error) {
+  if (image.isNull()) {
+    error = "Image is empty";
+    return false;
+  }
+
+  encoded.colorFormat = options.colorFormat;
+  encoded.width = image.width();
+  encoded.height = image.height();
+
+  encoded.compression = Compression::None;
+  encoded.swapped = false;
+
+  const EncodeFn encodeFn = encoderFor(options.colorFormat);
+  if (!encodeFn) {
+    error = "Unsupported color format";
+    return false;
+  }
+  if (!encodeFn(image, options, encoded, error)) {
+    return false;
+  }
+
+  // LVGL has a swapped variant of plain RGB565 only
+  if (options.swapBytes && encoded.colorFormat == ColorFormat::RGB565) {
+    uint8_t *pixels = reinterpret_cast<uint8_t *>(encoded.data.data());
+    PixelKernels::swapRgb565(pixels, pixels, encoded.data.size() / 2);
+    encoded.swapped = true;
+  }
+
+  if (options.alignment > 1) {
+    padRows(encoded, options.alignment);
+  }
+
+  encoded.rawSize = encoded.data.size();
+  if (options.compression != Compression::None) {
+    compress(encoded, options.compression);
+  }
+  return true;
+}
+
+QByteArray LVGLImageConverter::toCSource(const EncodedImage &encoded,
+                                         const QString &symbolName,
+                                         const QString &attributes) {
+  QByteArray source =
+      QString(kCHeaderTemplate)
+          .arg(symbolName.toUpper(), symbolName,
+               attributes.isEmpty() ? QString() : " " + attributes)
+          .toUtf8();
+
+  // A compressed stream has no rows to follow
+  appendHexRows(source, encoded.data.constData(), encoded.data.size(),
+                encoded.compression == Compression::None ? encoded.stride : 0);
+
+  source.append("\n};\n\n");
+  source.append(descriptorSource(encoded, symbolName,
+                                 QString("%1_map").arg(symbolName),
+                                 QString("sizeof(%1_map)").arg(symbolName)));
+  source.append('\n');
+  return source;
+}
+
+QByteArray LVGLImageConverter::descriptorSource(const EncodedImage &encoded,
+                                                const QString &symbolName,
+                                                const QString &dataExpression,
+                                                const QString &sizeExpression) {
+  QByteArray source;
+  if (encoded.compression != Compression::None) {
+    // Without the decoder LVGL fails at runtime with a blank image
+    const char *option =
+        encoded.compression == Compression::RLE ? "LV_USE_RLE" : "LV_USE_LZ4";
+    source.append(QString("#if !%1\n"
+                          "#error \"%2 is %3 compressed, enable %1 in "
+                          "lv_conf.h\"\n"
+                          "#endif\n\n")
+                      .arg(QString(option), symbolName,
+                           compressionName(encoded.compression))
+                      .toUtf8());
+  }
+  source.append(QString(kDescriptorTemplate)
+                    .arg(symbolName)
+                    .arg(QString(colorFormatName(encoded.colorFormat)) +
+                         (encoded.swapped ? "_SWAPPED" : ""))
+                    .arg(encoded.compression == Compression::None
+                             ? "0"
+                             : "LV_IMAGE_FLAGS_COMPRESSED")
+                    .arg(encoded.width)
+                    .arg(encoded.height)
+                    .arg(encoded.stride)
+                    .arg(sizeExpression)
+                    .arg(dataExpression)
+                    .toUtf8());
+  return source;
+}
+
+QByteArray LVGLImageConverter::hexRows(const QByteArray &data,
+                                       int bytesPerRow) {
+  QByteArray rows;
+  appendHexRows(rows, data.constData(), data.size(), bytesPerRow);
+  return rows;
+}
+
+QByteArray LVGLImageConverter::serialize(const EncodedImage &encoded) {
+  QByteArray bytes;
+  QDataStream stream(&bytes, QIODevice::WriteOnly);
+  stream << static_cast<qint32>(encoded.colorFormat)
+         << static_cast<qint32>(encoded.width)
+         << static_cast<qint32>(encoded.height)
+         << static_cast<qint32>(encoded.stride)
+         << static_cast<qint32>(encoded.compression)
+         << static_cast<qint32>(encoded.rawSize) << encoded.swapped
+         << encoded.data;
+  return bytes;
+}
+
+bool LVGLImageConverter::deserialize(const QByteArray &bytes,
+                                     EncodedImage &encoded) {
+  QDataStream stream(bytes);
+  qint32 format, width, height, stride, compression, rawSize;
+  stream >> format >> width >> height >> stride >> compression >> rawSize >>
+      encoded.swapped >> encoded.data;
+  if (stream.status() != QDataStream::Ok) {
+    return false;
+  }
+  encoded.colorFormat = static_cast<ColorFormat>(format);
+  encoded.width = width;
+  encoded.height = height;
+  encoded.stride = stride;
+  encoded.compression = static_cast<Compression>(compression);
+  encoded.rawSize = rawSize;
+  return true;
+}
+
+bool LVGLImageConverter::convert(const QByteArray &imageData,
+                                 const QString &outputFile,
+                                 const QString &symbolName,
+                                 const Options &options, QString &error) {
+  QImage image;
+  if (!image.loadFromData(imageData)) {
+    error = "Failed to decode image data";
+    return false;
+  }
+
+  EncodedImage encoded;
+  if (!encode(image, options, encoded, error)) {
+    return false;
+  }
+
+  QFile file(outputFile);
+  if (!file.open(QIODevice::WriteOnly)) {
+    error = QString("Failed to write %1: %2").arg(outputFile, file.errorString());
+    return false;
+  }
+  file.write(toCSource(encoded, symbolName, dataAttributes(options)));
+  file.close();
+  return true;
+}
+
+bool LVGLImageConverter::convertFile(const QString &imagePath,
+                                     const QString &outputFile,
+                                     const QString &symbolName,
+                                     const Options &options, QString &error) {
+  QFile input(imagePath);
+  if (!input.open(QIODevice::ReadOnly)) {
+    error = QString("Failed to read %1: %2").arg(imagePath, input.errorString());
+    return false;
+  }
+  if (!convert(input.readAll(), outputFile, symbolName, options, error)) {
+    error = QString("%1: %2").arg(imagePath, error);
+    return false;
+  }
+  return true;
+}
+
+QByteArray LVGLImageConverter::fingerprint(const Options &options) {
+  // Bump kRevision whenever the emitted C or the serialized encoding changes
+  // for identical input.
+  static const int kRevision = 3;
+  QString fingerprint = QString("rev=%1;cf=%2")
+                            .arg(kRevision)
+                            .arg(colorFormatName(options.colorFormat));
+  if (options.dither != Dither::None) {
+    fingerprint += QString(";dither=%1").arg(ditherName(options.dither));
+  }
+  if (options.alignment > 1) {
+    fingerprint += QString(";align=%1").arg(options.alignment);
+  }
+  if (options.swapBytes) {
+    fingerprint += ";swap";
+  }
+  if (options.compression != Compression::None) {
+    fingerprint +=
+        QString(";compress=%1").arg(compressionName(options.compression));
+  }
+  return fingerprint.toUtf8();
+}
+
+QString LVGLImageConverter::dataAttributes(const Options &options) {
+  QStringList attributes;
+  if (options.alignment > 1) {
+    attributes.append(QString("aligned(%1)").arg(options.alignment));
+  }
+  if (!options.section.isEmpty()) {
+    attributes.append(QString("section(\"%1\")").arg(options.section));
+  }
+  if (attributes.isEmpty()) {
+    return QString();
+  }
+  return QString("__attribute__((%1))").arg(attributes.join(", "));
+}
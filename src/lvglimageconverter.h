@@ -0,0 +1,91 @@
+#pragma once
+
+#include <QByteArray>
+#include <QImage>
+#include <QList>
+#include <QString>
+
+// In-process replacement for `LVGLImage.py --ofmt C`. Decodes the source image
+// with QImage and emits the same lv_img_dsc_t C source the LVGL script
+// writes, so image conversion no longer has to start the embedded Python.
+class LVGLImageConverter {
+public:
+  // Subset of lv_color_format_t the converter can emit. Names match the
+  // LV_COLOR_FORMAT_* suffixes.
+  enum class ColorFormat { RGB565, RGB565A8, RGB888, L8, A8, I1, I2, I4, I8 };
+
+  // Hides the banding that truncating 24-bit color to RGB565 produces on
+  // gradients. None matches LVGLImage.py output exactly.
+  enum class Dither { None, Ordered, FloydSteinberg };
+
+  // lv_image_compress_t; values are the method ids LVGL stores in the
+  // compressed data header. The firmware needs LV_USE_RLE / LV_USE_LZ4.
+  enum class Compression { None = 0, RLE = 1, LZ4 = 2 };
+
+  struct Options {
+    ColorFormat colorFormat = ColorFormat::RGB565;
+    Dither dither = Dither::None;
+    Compression compression = Compression::None;
+    // Rows are padded to, and arrays aligned on, this many bytes so the
+    // firmware can DMA straight out of flash. 1 keeps rows packed.
+    int alignment = 1;
+    // Linker section for the image arrays; empty keeps .rodata
+    QString section;
+    // Store RGB565 big-endian (RGB565_SWAPPED), the order SPI panels take
+    bool swapBytes = false;
+  };
+
+  struct EncodedImage {
+    ColorFormat colorFormat = ColorFormat::RGB565;
+    int width = 0;
+    int height = 0;
+    int stride = 0;
+    // When compressed, `data` is the 12-byte lv_image_compressed_t header
+    // followed by the stream, and `rawSize` the size it decompresses to.
+    Compression compression = Compression::None;
+    int rawSize = 0;
+    bool swapped = false;
+    QByteArray data;
+  };
+
+  static bool encode(const QImage &image, const Options &options,
+                     EncodedImage &encoded, QString &error);
+  // `attributes` becomes the default of the LV_ATTRIBUTE_{SYMBOL} hook
+  static QByteArray toCSource(const EncodedImage &encoded,
+                              const QString &symbolName,
+                              const QString &attributes = QString());
+  // The `const lv_image_dsc_t {symbol} = {...};` definition on its own, with
+  // caller-supplied expressions for .data and .data_size. Compressed images
+  // are preceded by an #error guard for the decoder they need.
+  static QByteArray descriptorSource(const EncodedImage &encoded,
+                                     const QString &symbolName,
+                                     const QString &dataExpression,
+                                     const QString &sizeExpression);
+  // `data` as the "0x..," rows of a C array initializer, `bytesPerRow` per
+  // line, formatted like the arrays in toCSource()
+  static QByteArray hexRows(const QByteArray &data, int bytesPerRow);
+  static bool convert(const QByteArray &imageData, const QString &outputFile,
+                      const QString &symbolName, const Options &options,
+                      QString &error);
+  static bool convertFile(const QString &imagePath, const QString &outputFile,
+                          const QString &symbolName, const Options &options,
+                          QString &error);
+
+  // Stable description of everything in `options` that changes the encoded
+  // image, plus the converter revision. Used as part of cache keys.
+  static QByteArray fingerprint(const Options &options);
+  // GCC attributes that place image data as `options` asks: aligned(N) and
+  // section("name"). Empty for packed .rodata.
+  static QString dataAttributes(const Options &options);
+
+  // Round-trips an EncodedImage through the conversion cache
+  static QByteArray serialize(const EncodedImage &encoded);
+  static bool deserialize(const QByteArray &bytes, EncodedImage &encoded);
+
+  static const char *colorFormatName(ColorFormat format);
+  static QList<ColorFormat> colorFormats();
+  // Bits per pixel on the device, excluding the palette of indexed formats
+  static int bitsPerPixel(ColorFormat format);
+  static const char *ditherName(Dither dither);
+  static const char *compressionName(Compression compression);
+};
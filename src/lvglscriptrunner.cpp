@@ -1,20 +1,135 @@
 #include "lvglscriptrunner.h"
+#include "buildjobs.h"
+#include "buildprofiler.h"
+#include "compilercache.h"
+#include "conversioncache.h"
 #include "embeddedpython.h"
+#include "flashplanner.h"
+#include "lvglimageconverter.h"
+#include "ninjalog.h"
+#include "processrunner.h"
+#include "tilepool.h"
 #include <QApplication>
+#include <QCryptographicHash>
 #include <QDebug>
 #include <QDir>
+#include <QElapsedTimer>
 #include <QFile>
 #include <QFileInfo>
 #include <QMessageBox>
 #include <QProcess>
 #include <QProgressDialog>
+#include <QRegularExpression>
+#include <QSaveFile>
+#include <QSet>
+#include <QSettings>
 #include <QTextStream>
+#include <QThreadPool>
 #include <QtConcurrent/QtConcurrent>
+#include <algorithm>
 #include <cmath>
 
 namespace {
 constexpr int kPwmTop = 1000;
 
+// Firmware side of the tiled layout in generated_images.h, following the
+// GENERATED_TILE_SIZE define
+const char *kTiledHeaderSource =
+    "extern const uint8_t generated_tile_pool[];\n"
+    "/* Byte offsets into generated_tile_pool, tile rows first; NULL for\n"
+    " * images stored whole */\n"
+    "extern const uint32_t *const image_tiles[IMAGE_COUNT];\n"
+    "\n"
+    "/* Returns image `index` ready to draw. Tiled images are composited into\n"
+    " * `buf` (images[index]->data_size bytes) and described by `dsc`; images\n"
+    " * stored whole are returned as they are. */\n"
+    "static inline const lv_image_dsc_t *\n"
+    "generated_image_compose(uint32_t index, uint8_t *buf, lv_image_dsc_t *dsc)\n"
+    "{\n"
+    "    const lv_image_dsc_t *src = images[index];\n"
+    "    const uint32_t *tiles = image_tiles[index];\n"
+    "    if (tiles == NULL) {\n"
+    "        return src;\n"
+    "    }\n"
+    "\n"
+    "    const uint32_t w = src->header.w;\n"
+    "    const uint32_t h = src->header.h;\n"
+    "    const uint32_t px = lv_color_format_get_size(src->header.cf);\n"
+    "    const uint32_t tile_row = GENERATED_TILE_SIZE * px;\n"
+    "    for (uint32_t y = 0; y < h; y += GENERATED_TILE_SIZE) {\n"
+    "        const uint32_t rows = LV_MIN(h - y, GENERATED_TILE_SIZE);\n"
+    "        for (uint32_t x = 0; x < w; x += GENERATED_TILE_SIZE) {\n"
+    "            const uint32_t bytes = LV_MIN(w - x, GENERATED_TILE_SIZE) * px;\n"
+    "            const uint8_t *tile = generated_tile_pool + *tiles++;\n"
+    "            for (uint32_t r = 0; r < rows; r++) {\n"
+    "                memcpy(buf + (y + r) * src->header.stride + x * px,\n"
+    "                       tile + r * tile_row, bytes);\n"
+    "            }\n"
+    "        }\n"
+    "    }\n"
+    "\n"
+    "    *dsc = *src;\n"
+    "    dsc->data = buf;\n"
+    "    return dsc;\n"
+    "}\n"
+    "\n";
+
+struct ConversionJob {
+  QString imagePath;
+  QString name;
+  QString outputFile;
+  LVGLImageConverter::Options options;
+  // Empty when the LVGL script fallback wrote the C file itself
+  LVGLImageConverter::EncodedImage encoded;
+  bool success = false;
+  // SHA-256 of the serialized `encoded`, set for native conversions; whole-
+  // image duplicates are found by it before any C file is written
+  QByteArray contentHash;
+  // The C file on disk was rewritten
+  bool changed = false;
+  QString output;
+  QString error;
+};
+
+// Writes `contents` to `path` unless the file already holds exactly that, so
+// the firmware build only recompiles generated sources whose text changed.
+// Changed files are written to a temporary file and renamed into place, so an
+// interrupted run never leaves a truncated source behind. `changed`, if
+// given, is set when the file was written.
+bool writeFileIfChanged(const QString &path, const QByteArray &contents,
+                        QString &error, bool *changed = nullptr) {
+  if (changed) {
+    *changed = false;
+  }
+  QFile existing(path);
+  if (existing.size() == contents.size() &&
+      existing.open(QIODevice::ReadOnly) && existing.readAll() == contents) {
+    qDebug() << "Unchanged, not rewritten:" << path;
+    return true;
+  }
+  existing.close();
+
+  QSaveFile file(path);
+  if (!file.open(QIODevice::WriteOnly) ||
+      file.write(contents) != contents.size() || !file.commit()) {
+    error = file.errorString();
+    return false;
+  }
+  if (changed) {
+    *changed = true;
+  }
+  return true;
+}
+
+// Path of an arm-none-eabi tool from the bundled toolchain
+QString toolchainTool(const QString &librariesPath, const QString &tool) {
+  QString path = librariesPath + "/arm-gnu-toolchain/bin/arm-none-eabi-" + tool;
+#ifdef Q_OS_WIN
+  path += ".exe";
+#endif
+  return path;
+}
+
 // CIE 1931 lightness curve: maps perceived brightness (0..100) to luminance
 // (0..top). Human brightness perception is roughly cubic, so a linear duty
 // ramp crowds all visible change into the bottom of the slider.
@@ -31,15 +146,212 @@ int cieLightnessToPwm(int percent, int top) {
   }
   return static_cast<int>(std::lround(Y * top));
 }
+
+// Concatenates the encoded pixels of every successful job into
+// generated_images.bin, turns that into generated_images_blob.o with objcopy
+// and returns the C that describes it: one lv_image_dsc_t per image pointing
+// at its offset in generated_images_blob. Offsets are kept at least 4-byte
+// aligned so every image starts on an LV_ATTRIBUTE_MEM_ALIGN boundary.
+//
+// firmware_hooks.cmake links the object into the firmware, so new pixel data
+// with an unchanged layout only relinks it. `objectChanged` is set when the
+// object was rewritten.
+bool writeImageBlob(const QDir &generatedDir,
+                    const QVector<ConversionJob> &jobs,
+                    const LVGLImageConverter::Options &placement,
+                    const QString &objcopy, QString &source,
+                    bool &objectChanged) {
+  const int alignment = qMax(4, placement.alignment);
+  const QString section = placement.section.isEmpty()
+                              ? QString(".rodata.generated_images_blob")
+                              : placement.section;
+  QByteArray blob;
+  QStringList descriptors;
+  for (const ConversionJob &job : jobs) {
+    if (!job.success) {
+      continue;
+    }
+    blob.append(
+        QByteArray((alignment - blob.size() % alignment) % alignment, '\0'));
+    descriptors.append(QString::fromUtf8(LVGLImageConverter::descriptorSource(
+        job.encoded, job.name,
+        QString("generated_images_blob + 0x%1").arg(blob.size(), 0, 16),
+        QString::number(job.encoded.data.size()))));
+    blob.append(job.encoded.data);
+  }
+
+  const QString blobPath = generatedDir.filePath("generated_images.bin");
+  QString error;
+  if (!writeFileIfChanged(blobPath, blob, error)) {
+    qDebug() << "Failed to write image blob at:" << blobPath << error;
+    return false;
+  }
+
+  // Run inside generated/ so the symbol objcopy derives from the input name
+  // is _binary_generated_images_bin_start. The object is regenerated every
+  // time, since the section and alignment matter as much as the data, and
+  // only replaces the old one when it differs.
+  const QString objectPath = generatedDir.filePath("generated_images_blob.o");
+  const QString tempPath = objectPath + ".tmp";
+  QProcess objcopyProcess;
+  objcopyProcess.setWorkingDirectory(generatedDir.absolutePath());
+  objcopyProcess.start(
+      objcopy,
+      QStringList()
+          << "-I" << "binary" << "-O" << "elf32-littlearm" << "-B" << "arm"
+          << "--rename-section"
+          << QString(".data=%1,alloc,load,readonly,data,contents").arg(section)
+          << "--set-section-alignment"
+          << QString("%1=%2").arg(section).arg(alignment) << "--redefine-sym"
+          << "_binary_generated_images_bin_start=generated_images_blob"
+          << "--strip-symbol" << "_binary_generated_images_bin_end"
+          << "--strip-symbol" << "_binary_generated_images_bin_size"
+          << "generated_images.bin" << QFileInfo(tempPath).fileName());
+  if (!objcopyProcess.waitForFinished(30000) ||
+      objcopyProcess.exitStatus() != QProcess::NormalExit ||
+      objcopyProcess.exitCode() != 0) {
+    qDebug() << "objcopy failed for:" << blobPath << objcopyProcess.errorString()
+             << objcopyProcess.readAllStandardError();
+    QFile::remove(tempPath);
+    return false;
+  }
+  QFile object(tempPath);
+  if (!object.open(QIODevice::ReadOnly)) {
+    qDebug() << "Failed to read:" << tempPath << object.errorString();
+    return false;
+  }
+  const QByteArray objectData = object.readAll();
+  object.close();
+  QFile::remove(tempPath);
+  if (!writeFileIfChanged(objectPath, objectData, error, &objectChanged)) {
+    qDebug() << "Failed to write image blob object at:" << objectPath << error;
+    return false;
+  }
+
+  source = QString("/* Pixel data: generated_images_blob.o */\n");
+  source += "extern const uint8_t generated_images_blob[];\n\n";
+  source += descriptors.join("\n");
+
+  qDebug() << QString("Packed %1 images into %2 (%3 bytes)")
+                  .arg(descriptors.size())
+                  .arg(objectPath)
+                  .arg(blob.size());
+  return true;
+}
+
+// Builds the tiled part of generated_images.c for the jobs flagged in
+// `tiled`: one pool of unique tiles, a tile map per image and a descriptor
+// whose .data is left NULL for generated_image_compose() to fill in. Returns
+// the flash bytes saved compared to storing those images whole.
+qint64 tiledImagesSource(const QVector<ConversionJob> &jobs,
+                         const QVector<bool> &tiled,
+                         const QString &attributes, QString &source) {
+  TilePool pool;
+  QString maps;
+  qint64 wholeBytes = 0;
+  qint64 mapBytes = 0;
+  for (int i = 0; i < jobs.size(); ++i) {
+    if (!tiled[i]) {
+      continue;
+    }
+    const ConversionJob &job = jobs[i];
+    const QVector<quint32> offsets = pool.add(job.encoded);
+    wholeBytes += job.encoded.rawSize;
+    mapBytes += offsets.size() * qint64(sizeof(quint32));
+
+    maps += QString("static const uint32_t %1_tiles[] = {").arg(job.name);
+    for (int t = 0; t < offsets.size(); ++t) {
+      maps += t % 8 == 0 ? "\n    " : " ";
+      maps += QString("0x%1,").arg(offsets[t], 0, 16);
+    }
+    maps += "\n};\n\n";
+    maps += QString::fromUtf8(LVGLImageConverter::descriptorSource(
+        job.encoded, job.name, "NULL", QString::number(job.encoded.rawSize)));
+    maps += "\n";
+  }
+
+  source = QString("/* Tile pool: %1 unique of %2 tiles, %3 bytes */\n")
+               .arg(pool.tileCount())
+               .arg(pool.tilesAdded())
+               .arg(pool.data().size());
+  source += "const LV_ATTRIBUTE_MEM_ALIGN LV_ATTRIBUTE_LARGE_CONST";
+  source += attributes.isEmpty() ? "\n" : " " + attributes + "\n";
+  source += "uint8_t generated_tile_pool[] = {";
+  source += QString::fromLatin1(LVGLImageConverter::hexRows(
+      pool.data(), TilePool::kTileSize * 2));
+  source += "};\n\n";
+  source += maps;
+
+  qDebug() << QString("Tiled %1 tiles into %2 unique (%3 bytes + %4 bytes of "
+                      "tile maps)")
+                  .arg(pool.tilesAdded())
+                  .arg(pool.tileCount())
+                  .arg(pool.data().size())
+                  .arg(mapBytes);
+  return wholeBytes - pool.data().size() - mapBytes;
+}
+
+// Deletes .c files in generated/ that are not part of the current output
+// (images removed since the last run, or per-image sources left behind when
+// switching to blob or tiled mode) so the firmware never compiles them.
+// Returns whether any were removed.
+bool removeStaleSources(const QDir &generatedDir, const QStringList &keep) {
+  bool removed = false;
+  const QStringList sources =
+      generatedDir.entryList({"*.c"}, QDir::Files | QDir::NoDotAndDotDot);
+  for (const QString &fileName : sources) {
+    const QString path = generatedDir.filePath(fileName);
+    if (!keep.contains(path) && QFile::remove(path)) {
+      qDebug() << "Removed stale generated source:" << path;
+      removed = true;
+    }
+  }
+  return removed;
+}
 }  // namespace
 
 LVGLScriptRunner::LVGLScriptRunner(QWidget *parent)
     : QObject(parent), m_parent(parent), m_embeddedPython(nullptr),
-      m_futureWatcher(nullptr) {
+      m_futureWatcher(nullptr), m_conversionPool(nullptr),
+      m_conversionCache(nullptr), m_compilerCache(nullptr),
+      m_processRunner(nullptr) {
   m_embeddedPython = new EmbeddedPython(parent);
+  m_conversionCache = new ConversionCache(
+      ConversionCache::defaultDirectory(),
+      QSettings().value("conversion/cacheMaxMB", 256).toLongLong() * 1024 *
+          1024);
+  if (QSettings().value("build/compilerCache", true).toBool()) {
+    m_compilerCache = new CompilerCache(
+        getLibrariesPath(), CompilerCache::defaultDirectory(),
+        QSettings().value("build/compilerCacheMaxMB", 2048).toLongLong() *
+            1024 * 1024);
+  }
+  m_conversionPool = new QThreadPool(this);
+  setMaxConversionThreads(
+      QSettings().value("conversion/maxThreads", 0).toInt());
   m_futureWatcher = new QFutureWatcher<bool>(this);
   connect(m_futureWatcher, &QFutureWatcher<bool>::finished,
           this, &LVGLScriptRunner::onProcessingFinished);
+
+  m_processRunner = new ProcessRunner(this);
+  connect(m_processRunner, &ProcessRunner::lineReceived, this,
+          [this](const QString &line, bool isError) {
+            qDebug().noquote() << (isError ? "[stderr]" : "[stdout]") << line;
+            if (m_stage == Stage::Build || m_stage == Stage::Relink) {
+              m_buildProfiler.addOutputLine(line);
+            }
+            // Ninja names the step that broke the build, e.g.
+            // "FAILED: CMakeFiles/fw.dir/Unity/unity_lvgl_0_c.c.obj"
+            static const QRegularExpression unityStep(
+                "^FAILED: .*[/\\\\]Unity[/\\\\]unity_(lvgl|nrf5_sdk)_");
+            if (m_stage == Stage::Build && unityStep.match(line).hasMatch()) {
+              m_unityStepFailed = true;
+            }
+          });
+  connect(m_processRunner, &ProcessRunner::progressChanged, this,
+          [this](int percent) { onStageProgress(percent); });
+  connect(m_processRunner, &ProcessRunner::finished, this,
+          &LVGLScriptRunner::onStageFinished);
 }
 
 LVGLScriptRunner::~LVGLScriptRunner() {
@@ -49,6 +361,8 @@ LVGLScriptRunner::~LVGLScriptRunner() {
   if (m_embeddedPython) {
     m_embeddedPython->deleteLater();
   }
+  delete m_conversionCache;
+  delete m_compilerCache;
 }
 
 QString LVGLScriptRunner::getLibrariesPath() {
@@ -80,28 +394,104 @@ void LVGLScriptRunner::setBrightness(int percent) {
   m_brightness = percent;
 }
 
+void LVGLScriptRunner::setMaxConversionThreads(int threads) {
+  // 0 (the default) sizes the pool to the core count; an explicit limit is
+  // still capped there since conversion is CPU-bound.
+  const int cores = QThread::idealThreadCount();
+  if (threads <= 0 || threads > cores) {
+    threads = cores;
+  }
+  m_conversionPool->setMaxThreadCount(threads);
+}
+
+void LVGLScriptRunner::setOutputMode(OutputMode mode) { m_outputMode = mode; }
+
+void LVGLScriptRunner::setFirmwareProfile(FirmwareProfile profile) {
+  m_firmwareProfile = profile;
+}
+
+QString LVGLScriptRunner::buildType(FirmwareProfile profile) {
+  switch (profile) {
+  case FirmwareProfile::Debug:
+    return "Debug";
+  case FirmwareProfile::Release:
+    return "Release";
+  case FirmwareProfile::MinSize:
+    return "MinSizeRel";
+  }
+  return "Debug";
+}
+
+qint64 LVGLScriptRunner::lastFirmwareBytes(FirmwareProfile profile) {
+  return QSettings()
+      .value("firmware/flashBytes/" + buildType(profile), -1)
+      .toLongLong();
+}
+
+void LVGLScriptRunner::setDither(LVGLImageConverter::Dither dither) {
+  m_conversionOptions.dither = dither;
+}
+
+void LVGLScriptRunner::setImageAlignment(int bytes) {
+  // Power of two up to the tile size, so tile pool offsets stay aligned too
+  if (bytes < 1 || bytes > 256 || (bytes & (bytes - 1)) != 0) {
+    qDebug() << "Ignoring invalid image alignment:" << bytes;
+    bytes = 1;
+  }
+  m_conversionOptions.alignment = bytes;
+}
+
+void LVGLScriptRunner::setImageSection(const QString &section) {
+  static const QRegularExpression kSectionName("^[A-Za-z0-9_.]*$");
+  if (!kSectionName.match(section).hasMatch()) {
+    qDebug() << "Ignoring invalid section name:" << section;
+    m_conversionOptions.section.clear();
+    return;
+  }
+  m_conversionOptions.section = section;
+}
+
+void LVGLScriptRunner::setSwapBytes(bool swap) {
+  m_conversionOptions.swapBytes = swap;
+}
+
+void LVGLScriptRunner::setColorFormats(
+    const QList<LVGLImageConverter::ColorFormat> &formats) {
+  m_colorFormats = formats;
+}
+
+void LVGLScriptRunner::setCompressions(
+    const QList<LVGLImageConverter::Compression> &compressions) {
+  m_compressions = compressions;
+}
+
 void LVGLScriptRunner::processImagesAsync(const QStringList &imagePaths,
                                           const QString &outputDir) {
-  // Run the processing in a separate thread
+  m_uploadTimer.start();
+  m_stageTimings.clear();
+
+  // Run the processing in a separate thread; the firmware stages that
+  // follow run on this one without blocking it
   QFuture<bool> future = QtConcurrent::run([this, imagePaths, outputDir]() {
     return processImages(imagePaths, outputDir);
   });
 
   m_futureWatcher->setFuture(future);
   emit processingProgress("Starting image processing...");
+  emit stageProgress("Converting", -1);
 }
 
 void LVGLScriptRunner::onProcessingFinished() {
-  bool success = m_futureWatcher->result();
-  QString message;
-
-  if (success) {
-    message = "Firmware has been successfully flashed to the nRF52 device!";
-  } else {
-    message = "Processing failed. Check the console for details.";
+  if (!m_futureWatcher->result()) {
+    finishProcessing(false,
+                     "Processing failed. Check the console for details.");
+    return;
   }
 
-  emit processingCompleted(success, message);
+  // Automatically proceed to build and flash without confirmation dialogs
+  m_stageTimings.append(
+      QString("images %1 ms").arg(m_uploadTimer.elapsed()));
+  startBuild();
 }
 
 bool LVGLScriptRunner::processImages(const QStringList &imagePaths,
@@ -110,20 +500,6 @@ bool LVGLScriptRunner::processImages(const QStringList &imagePaths,
     return false;
   }
 
-  // Check if LVGL script exists
-  QString scriptPath = getLVGLScriptPath();
-  if (!QFile::exists(scriptPath)) {
-    QMessageBox::critical(m_parent, "Script Missing",
-                          "LVGL image script not found. Please ensure LVGL "
-                          "library is properly installed.");
-    return false;
-  }
-
-  // Ensure Python is ready
-  if (!ensurePythonReady()) {
-    return false;
-  }
-
   // Ensure output directory exists and use QDir for proper path handling
   QDir generatedDir(outputDir);
   if (!generatedDir.exists()) {
@@ -131,10 +507,10 @@ bool LVGLScriptRunner::processImages(const QStringList &imagePaths,
   }
   QString absoluteOutputDir = generatedDir.absolutePath();
 
-  QStringList processedFiles;
-  QStringList headerDeclarations;
-  QStringList arrayNames;
-
+  // Resolve every symbol name up front so the parallel stage below never
+  // has two jobs writing the same {name}.c.
+  QVector<ConversionJob> jobs;
+  QSet<QString> usedNames;
   for (int i = 0; i < imagePaths.size(); ++i) {
     const QString &imagePath = imagePaths[i];
     QFileInfo imageInfo(imagePath);
@@ -156,59 +532,299 @@ bool LVGLScriptRunner::processImages(const QStringList &imagePaths,
       baseName.prepend("img_");
     }
 
-    QString outputFile = generatedDir.filePath(baseName + ".c");
+    // Same file name in two folders: keep both symbols distinct
+    const QString stem = baseName;
+    for (int suffix = 2; usedNames.contains(baseName); ++suffix) {
+      baseName = QString("%1_%2").arg(stem).arg(suffix);
+    }
+    usedNames.insert(baseName);
+
+    ConversionJob job;
+    job.imagePath = imagePath;
+    job.name = baseName;
+    job.outputFile = generatedDir.filePath(baseName + ".c");
+    job.options = m_conversionOptions;
+    if (i < m_colorFormats.size()) {
+      job.options.colorFormat = m_colorFormats[i];
+    }
+    if (i < m_compressions.size()) {
+      job.options.compression = m_compressions[i];
+    }
+    jobs.append(job);
+  }
+
+  qDebug() << QString("Converting %1 images on up to %2 threads...")
+                  .arg(jobs.size())
+                  .arg(m_conversionPool->maxThreadCount());
+
+  QElapsedTimer conversionTimer;
+  conversionTimer.start();
+  m_conversionCache->resetCounters();
+
+  const bool blobMode = m_outputMode == OutputMode::BinaryBlob;
+  const bool tiledMode = m_outputMode == OutputMode::Tiled;
+
+  // Fan the conversions out on a dedicated pool: this function already runs
+  // on the global pool, and blocking it on its own tasks could starve them.
+  QtConcurrent::blockingMap(
+      m_conversionPool, jobs,
+      [this, absoluteOutputDir, blobMode, tiledMode](ConversionJob &job) {
+        QFile input(job.imagePath);
+        if (!input.open(QIODevice::ReadOnly)) {
+          job.error = input.errorString();
+          return;
+        }
+        const QByteArray imageData = input.readAll();
+        input.close();
+
+        // The cache holds encoded pixels, so both output modes share entries
+        const LVGLImageConverter::Options &options = job.options;
+        const QByteArray cacheKey = ConversionCache::key(
+            imageData, job.name, LVGLImageConverter::fingerprint(options));
+        QByteArray cached;
+        if (m_conversionCache->fetchData(cacheKey, cached) &&
+            LVGLImageConverter::deserialize(cached, job.encoded)) {
+          job.success = true;
+          job.output = "Reused cached conversion";
+          job.contentHash =
+              QCryptographicHash::hash(cached, QCryptographicHash::Sha256);
+        } else {
+          QImage image;
+          if (!image.loadFromData(imageData)) {
+            job.error = "Failed to decode image data";
+          } else {
+            job.success = LVGLImageConverter::encode(image, options,
+                                                     job.encoded, job.error);
+          }
+          if (job.success) {
+            const QByteArray serialized =
+                LVGLImageConverter::serialize(job.encoded);
+            job.contentHash = QCryptographicHash::hash(
+                serialized, QCryptographicHash::Sha256);
+            m_conversionCache->storeData(cacheKey, serialized);
+          }
+        }
+
+        if (blobMode) {
+          // No Python fallback here: the script can only write C arrays
+          return;
+        }
+
+        if (job.success) {
+          // The C file is written once duplicates are known, below
+          return;
+        }
+
+        // The LVGL Python script is only a fallback for images the native
+        // converter cannot decode. Its output is not cached.
+        qDebug() << "Native conversion failed:" << job.error;
+        if (options.dither != LVGLImageConverter::Dither::None) {
+          qDebug() << "LVGL script fallback ignores dithering for:"
+                   << job.imagePath;
+        }
+        if (options.swapBytes) {
+          qDebug() << "LVGL script fallback writes unswapped RGB565 for:"
+                   << job.imagePath;
+        }
+        job.success = runLVGLScript(
+            job.imagePath, absoluteOutputDir, job.name,
+            LVGLImageConverter::colorFormatName(options.colorFormat),
+            LVGLImageConverter::compressionName(options.compression),
+            job.output, job.error);
+        job.changed = true;
+      });
+
+  qDebug() << "Image conversion took" << conversionTimer.elapsed() << "ms";
+
+  m_conversionCache->evict();
+  qDebug() << QString("Conversion cache: %1 hits, %2 misses, %3 KiB stored")
+                  .arg(m_conversionCache->hits())
+                  .arg(m_conversionCache->misses())
+                  .arg(m_conversionCache->sizeBytes() / 1024);
+
+  // Whole-image duplicates (same pixels, format and compression) collapse
+  // onto their first occurrence: only that one is stored, and the
+  // duplicate's symbol becomes an alias of it in generated_images.h.
+  QVector<int> sharedWith(jobs.size(), -1);
+  QHash<QByteArray, int> firstByContent;
+  qint64 duplicateBytes = 0;
+  int duplicateCount = 0;
+  for (int i = 0; i < jobs.size(); ++i) {
+    const ConversionJob &job = jobs[i];
+    if (!job.success || job.contentHash.isEmpty()) {
+      continue;
+    }
+    const auto first = firstByContent.constFind(job.contentHash);
+    if (first == firstByContent.constEnd()) {
+      firstByContent.insert(job.contentHash, i);
+      continue;
+    }
+    sharedWith[i] = first.value();
+    duplicateBytes += job.encoded.data.size();
+    ++duplicateCount;
+    qDebug() << job.name << "is identical to" << jobs[first.value()].name
+             << "and shares its data";
+  }
+
+  // Only images that are stored get a C file, so a duplicate's file is not
+  // rewritten on every run just to be removed as stale again. Images that
+  // go into the blob or the tile pool have none either.
+  QVector<ConversionJob *> sourceJobs;
+  for (int i = 0; i < jobs.size(); ++i) {
+    ConversionJob &job = jobs[i];
+    if (job.success && !job.contentHash.isEmpty() && sharedWith[i] < 0 &&
+        !blobMode && !(tiledMode && TilePool::canTile(job.encoded))) {
+      sourceJobs.append(&job);
+    }
+  }
+  QtConcurrent::blockingMap(
+      m_conversionPool, sourceJobs, [](ConversionJob *job) {
+        job->success = writeFileIfChanged(
+            job->outputFile,
+            LVGLImageConverter::toCSource(
+                job->encoded, job->name,
+                LVGLImageConverter::dataAttributes(job->options)),
+            job->error, &job->changed);
+      });
+  for (int i = 0; i < jobs.size(); ++i) {
+    if (sharedWith[i] >= 0 && !jobs[sharedWith[i]].success) {
+      jobs[i].success = false;
+      jobs[i].error = QString("%1 shares the data of %2, which failed")
+                          .arg(jobs[i].name, jobs[sharedWith[i]].name);
+    }
+  }
+
+  // Report and collect in input order so the generated sources stay
+  // deterministic regardless of which conversion finished first.
+  QVector<bool> tiled(jobs.size(), false);
+  QSet<QString> tiledNames;
+  QStringList processedFiles;
+  QStringList headerDeclarations;
+  QStringList arrayNames;
+  qint64 rawBytes = 0;
+  qint64 storedBytes = 0;
 
-    qDebug() << QString("Processing %1 (%2 of %3)...")
-                    .arg(imageInfo.fileName())
+  for (int i = 0; i < jobs.size(); ++i) {
+    const ConversionJob &job = jobs[i];
+    qDebug() << QString("Processed %1 (%2 of %3)")
+                    .arg(QFileInfo(job.imagePath).fileName())
                     .arg(i + 1)
-                    .arg(imagePaths.size());
-
-    // Run LVGL script with correct arguments
-    // Note: --output expects a directory path, the script creates
-    // {dir}/{name}.c
-    QStringList arguments;
-    arguments << imagePath;
-    arguments << "--output" << absoluteOutputDir;
-    arguments << "--ofmt" << "C";
-    arguments << "--cf" << "RGB565"; // Avoid pngquant dependency
-    arguments << "--name" << baseName;
-
-    QString output, error;
-    qDebug() << "Running LVGL script with arguments:" << arguments;
-    bool success =
-        m_embeddedPython->runScript(scriptPath, arguments, output, error);
-
-    if (success) {
-      processedFiles.append(outputFile);
-      arrayNames.append(baseName);
+                    .arg(jobs.size());
+
+    if (job.success && sharedWith[i] >= 0) {
+      const QString &target = jobs[sharedWith[i]].name;
+      arrayNames.append(target);
       headerDeclarations.append(
-          QString("extern const lv_img_dsc_t %1;").arg(baseName));
-      qDebug() << "Successfully processed:" << imagePath;
-      qDebug() << "Output:" << output;
+          QString("#define %1 %2").arg(job.name, target));
+      qDebug() << "Successfully processed:" << job.imagePath;
+    } else if (job.success) {
+      tiled[i] = tiledMode && job.encoded.rawSize > 0 &&
+                 TilePool::canTile(job.encoded);
+      if (tiled[i]) {
+        tiledNames.insert(job.name);
+      } else if (!blobMode) {
+        processedFiles.append(job.outputFile);
+      }
+      arrayNames.append(job.name);
+      headerDeclarations.append(
+          QString("extern const lv_img_dsc_t %1;").arg(job.name));
+      qDebug() << "Successfully processed:" << job.imagePath;
+      qDebug() << "Output:" << job.output;
+
+      const LVGLImageConverter::EncodedImage &encoded = job.encoded;
+      if (encoded.rawSize > 0) {
+        rawBytes += encoded.rawSize;
+        storedBytes += encoded.data.size();
+        qDebug() << QString("%1: %2 -> %3 bytes (%4, %5%)")
+                        .arg(job.name)
+                        .arg(encoded.rawSize)
+                        .arg(encoded.data.size())
+                        .arg(LVGLImageConverter::compressionName(
+                            encoded.compression))
+                        .arg(100.0 * encoded.data.size() / encoded.rawSize, 0,
+                             'f', 1);
+      }
     } else {
-      qDebug() << "Failed to process:" << imagePath;
-      qDebug() << "Error:" << error;
-      qDebug() << "Output:" << output;
+      qDebug() << "Failed to process:" << job.imagePath;
+      qDebug() << "Error:" << job.error;
+      qDebug() << "Output:" << job.output;
     }
   }
 
-  if (processedFiles.isEmpty()) {
+  if (arrayNames.isEmpty()) {
     qDebug() << "No images were successfully processed.";
     return false;
   }
 
+  // Without a tileable image the set is written as plain C arrays
+  const bool tiledOutput = !tiledNames.isEmpty();
+  QString tiledSource;
+  qint64 tiledBytes = 0;
+  if (tiledOutput) {
+    tiledBytes = tiledImagesSource(
+        jobs, tiled, LVGLImageConverter::dataAttributes(m_conversionOptions),
+        tiledSource);
+  }
+
+  if (rawBytes > 0) {
+    QString summary =
+        QString("Image data: %1 KiB, %2% of %3 KiB uncompressed")
+            .arg(storedBytes / 1024.0, 0, 'f', 1)
+            .arg(100.0 * storedBytes / rawBytes, 0, 'f', 1)
+            .arg(rawBytes / 1024.0, 0, 'f', 1);
+    if (duplicateCount > 0 || tiledOutput) {
+      // Tiling can cost a little on sets without shared regions
+      summary += QString(", %1 KiB saved by deduplication (%2 duplicate "
+                         "images, %3 KiB by tiling)")
+                     .arg((duplicateBytes + tiledBytes) / 1024.0, 0, 'f', 1)
+                     .arg(duplicateCount)
+                     .arg(tiledBytes / 1024.0, 0, 'f', 1);
+    }
+    qDebug() << summary;
+    emit processingProgress(summary);
+  }
+
+  // Whether anything the firmware compiles was rewritten; when only the blob
+  // object changed, the firmware just needs relinking
+  bool sourcesChanged = false;
+  for (const ConversionJob &job : jobs) {
+    sourcesChanged = sourcesChanged || job.changed;
+  }
+
+  QString blobSource;
+  bool blobChanged = false;
+  if (blobMode) {
+    QVector<ConversionJob> storedJobs;
+    for (int i = 0; i < jobs.size(); ++i) {
+      if (sharedWith[i] < 0) {
+        storedJobs.append(jobs[i]);
+      }
+    }
+    if (!writeImageBlob(generatedDir, storedJobs, m_conversionOptions,
+                        toolchainTool(getLibrariesPath(), "objcopy"),
+                        blobSource, blobChanged)) {
+      return false;
+    }
+  } else {
+    QFile::remove(generatedDir.filePath("generated_images.bin"));
+    sourcesChanged =
+        QFile::remove(generatedDir.filePath("generated_images_blob.o")) ||
+        sourcesChanged;
+  }
+
   // Create combined header file in the generated directory
   QString headerPath = generatedDir.filePath("generated_images.h");
-  QFile headerFile(headerPath);
-  if (headerFile.open(QIODevice::WriteOnly)) {
-    QTextStream stream(&headerFile);
+  QString header;
+  {
+    QTextStream stream(&header);
 
     // Header guard
     stream << "#pragma once\n\n";
     stream << "#ifdef __cplusplus\n";
     stream << "extern \"C\" {\n";
     stream << "#endif\n\n";
-    stream << "#include \"lvgl.h\"\n\n";
+    stream << "#include \"lvgl.h\"\n";
+    stream << "#include <string.h>\n\n";
 
     // Declarations
     for (const QString &declaration : headerDeclarations) {
@@ -219,21 +835,43 @@ bool LVGLScriptRunner::processImages(const QStringList &imagePaths,
     stream << QString("#define IMAGE_COUNT %1\n").arg(arrayNames.size());
     stream << "extern const lv_img_dsc_t* images[IMAGE_COUNT];\n\n";
 
+    stream << QString("#define GENERATED_IMAGES_TILED %1\n\n")
+                  .arg(tiledOutput ? 1 : 0);
+    if (tiledOutput) {
+      stream << QString("#define GENERATED_TILE_SIZE %1\n\n")
+                    .arg(TilePool::kTileSize);
+      stream << kTiledHeaderSource;
+    }
+
     stream << "#ifdef __cplusplus\n";
     stream << "}\n";
     stream << "#endif\n";
-
-    headerFile.close();
   }
+  QString writeError;
+  bool fileChanged = false;
+  if (!writeFileIfChanged(headerPath, header.toUtf8(), writeError,
+                          &fileChanged)) {
+    qDebug() << "Failed to write generated_images.h at:" << headerPath
+             << writeError;
+    return false;
+  }
+  sourcesChanged = sourcesChanged || fileChanged;
 
   // Create implementation file for image array in the generated directory
   QString implPath = generatedDir.filePath("generated_images.c");
-  QFile implFile(implPath);
-  if (implFile.open(QIODevice::WriteOnly)) {
-    QTextStream stream(&implFile);
+  QString impl;
+  {
+    QTextStream stream(&impl);
 
     stream << "#include \"generated_images.h\"\n\n";
 
+    if (blobMode) {
+      stream << blobSource;
+    }
+    if (tiledOutput) {
+      stream << tiledSource;
+    }
+
     stream << "\n";
     stream << "const lv_img_dsc_t* images[IMAGE_COUNT] = {\n";
     for (int i = 0; i < arrayNames.size(); ++i) {
@@ -245,116 +883,292 @@ bool LVGLScriptRunner::processImages(const QStringList &imagePaths,
     }
     stream << "};\n";
 
-    implFile.close();
+    if (tiledOutput) {
+      stream << "\n";
+      stream << "const uint32_t *const image_tiles[IMAGE_COUNT] = {\n";
+      for (int i = 0; i < arrayNames.size(); ++i) {
+        stream << "    "
+               << (tiledNames.contains(arrayNames[i])
+                       ? QString("%1_tiles").arg(arrayNames[i])
+                       : QString("NULL"));
+        if (i < arrayNames.size() - 1) {
+          stream << ",";
+        }
+        stream << "\n";
+      }
+      stream << "};\n";
+    }
+  }
+  if (!writeFileIfChanged(implPath, impl.toUtf8(), writeError,
+                          &fileChanged)) {
+    qDebug() << "Failed to write generated_images.c at:" << implPath
+             << writeError;
+    return false;
   }
+  sourcesChanged = sourcesChanged || fileChanged;
+
+  sourcesChanged =
+      removeStaleSources(generatedDir, processedFiles + QStringList(implPath)) ||
+      sourcesChanged;
 
   // Emit display config header consumed by firmware main.c.
   // Brightness is linearized GUI-side via CIE 1931 so the firmware can just
   // program the count directly into the PWM peripheral (1000-step top).
   const int pwmValue = cieLightnessToPwm(m_brightness, kPwmTop);
   QString configPath = generatedDir.filePath("generated_config.h");
-  QFile configFile(configPath);
-  if (configFile.open(QIODevice::WriteOnly)) {
-    QTextStream stream(&configFile);
+  QString config;
+  {
+    QTextStream stream(&config);
     stream << "#pragma once\n\n";
     stream << "#define LCD_BRIGHTNESS_PERCENT " << m_brightness << "\n";
     stream << "#define LCD_BRIGHTNESS_PWM_TOP " << kPwmTop << "\n";
     stream << "#define LCD_BRIGHTNESS_PWM_VALUE " << pwmValue << "\n";
-    configFile.close();
-  } else {
-    qDebug() << "Failed to write generated_config.h at:" << configPath;
+    stream << "\n";
+    stream << "/* Image rows are padded to, and image data starts on, this many\n";
+    stream << " * bytes. Rows can be moved into SPIM EasyDMA buffers (RAM only)\n";
+    stream << " * with aligned block copies, or DMAed directly when\n";
+    stream << " * LCD_IMAGE_SECTION is linked into RAM. */\n";
+    stream << "#define LCD_IMAGE_ALIGN " << m_conversionOptions.alignment
+           << "\n";
+    if (!m_conversionOptions.section.isEmpty()) {
+      stream << "#define LCD_IMAGE_SECTION \"" << m_conversionOptions.section
+             << "\"\n";
+    }
+    stream << "\n";
+    stream << "/* RGB565 images are stored big-endian (RGB565_SWAPPED), the\n";
+    stream << " * order the panel takes over SPI. Render into an RGB565_SWAPPED\n";
+    stream << " * display buffer and flush without lv_draw_sw_rgb565_swap(). */\n";
+    stream << "#define LCD_IMAGES_PRESWAPPED "
+           << (m_conversionOptions.swapBytes ? 1 : 0) << "\n";
+  }
+  if (!writeFileIfChanged(configPath, config.toUtf8(), writeError,
+                          &fileChanged)) {
+    qDebug() << "Failed to write generated_config.h at:" << configPath
+             << writeError;
     return false;
   }
+  sourcesChanged = sourcesChanged || fileChanged;
 
-  // Automatically proceed to build and flash without confirmation dialogs
-  if (!configureAndBuildMCU()) {
-    qDebug() << "Failed to configure and build the MCU firmware.";
-    return false;
+  if (blobMode && !sourcesChanged) {
+    qDebug() << (blobChanged ? "Only the image data changed"
+                             : "No generated file changed");
   }
 
+  // Read on the GUI thread once this returns, by startBuild()
+  m_imageDataOnly = blobMode && !sourcesChanged;
   return true;
 }
 
-bool LVGLScriptRunner::configureAndBuildMCU() {
-  QString appDir = QApplication::applicationDirPath();
-  QString buildMcuDir = appDir + "/build_mcu";
-
-  // Check if build_mcu directory exists
-  if (!QDir(buildMcuDir).exists()) {
-    qDebug() << "build_mcu directory not found at:" << buildMcuDir;
+bool LVGLScriptRunner::runLVGLScript(const QString &imagePath,
+                                     const QString &outputDir,
+                                     const QString &name,
+                                     const QString &colorFormat,
+                                     const QString &compression,
+                                     QString &output, QString &error) {
+  // Check if LVGL script exists
+  QString scriptPath = getLVGLScriptPath();
+  if (!QFile::exists(scriptPath)) {
+    error = "LVGL image script not found. Please ensure LVGL library is "
+            "properly installed.";
     return false;
   }
 
-  // Determine the configure script based on OS
-  QString configureScript;
-#ifdef Q_OS_WIN
-  configureScript = buildMcuDir + "/configure.bat";
-#else
-  configureScript = buildMcuDir + "/configure.sh";
-#endif
-
-  if (!QFile::exists(configureScript)) {
-    qDebug() << "Configure script not found at:" << configureScript;
+  // Ensure Python is ready
+  if (!ensurePythonReady()) {
+    error = "Embedded Python not available";
     return false;
   }
 
-  qDebug() << "Running configure script:" << configureScript;
-
-  // Run the configure script
-  QProcess configureProcess;
-  configureProcess.setWorkingDirectory(buildMcuDir);
+  // Run LVGL script with correct arguments
+  // Note: --output expects a directory path, the script creates
+  // {dir}/{name}.c
+  QStringList arguments;
+  arguments << imagePath;
+  arguments << "--output" << outputDir;
+  arguments << "--ofmt" << "C";
+  arguments << "--cf" << colorFormat;
+  arguments << "--compress" << compression;
+  arguments << "--name" << name;
+
+  qDebug() << "Running LVGL script with arguments:" << arguments;
+  return m_embeddedPython->runScript(scriptPath, arguments, output, error);
+}
 
-#ifdef Q_OS_WIN
-  configureProcess.start("cmd.exe", QStringList() << "/c" << "configure.bat");
-#else
-  configureProcess.start("/bin/bash", QStringList() << "configure.sh");
-#endif
+QString LVGLScriptRunner::buildMcuDir() const {
+  return QApplication::applicationDirPath() + "/build_mcu";
+}
 
-  if (!configureProcess.waitForStarted()) {
-    qDebug() << "Failed to start configure process";
-    return false;
+void LVGLScriptRunner::startBuild() {
+  // Check if build_mcu directory exists
+  if (!QDir(buildMcuDir()).exists()) {
+    qDebug() << "build_mcu directory not found at:" << buildMcuDir();
+    finishProcessing(false, "Firmware build directory (build_mcu) not found.");
+    return;
   }
 
-  // Wait for both configure and build to complete (5 minutes timeout since
-  // build is included)
-  if (!configureProcess.waitForFinished(300000)) {
-    qDebug() << "Configure and build process timed out";
-    configureProcess.kill();
-    return false;
+  // The scripts pick the compiler cache and the prebuilt LVGL/SDK archives
+  // (libraries/prebuilt, see prebuilt_libraries.cmake) up from the
+  // environment
+  m_buildEnvironment = QProcessEnvironment::systemEnvironment();
+  if (m_compilerCache) {
+    m_compilerCache->configure(m_buildEnvironment);
+    m_compilerCache->resetStats();
   }
+  m_buildEnvironment.insert(
+      "LCD_PREBUILT_LIBRARIES",
+      QSettings().value("build/prebuiltLibraries", true).toBool() ? "1" : "0");
+  // The configure scripts take the build type from here when it is not
+  // passed on the command line
+  m_buildEnvironment.insert("LCD_BUILD_TYPE", buildType(m_firmwareProfile));
+  // Off by default: with LTO every relink generates the code of LVGL and
+  // the SDK again (see toolchain-arm-none-eabi.cmake)
+  m_buildEnvironment.insert(
+      "LCD_FIRMWARE_LTO",
+      QSettings().value("build/lto", false).toBool() ? "1" : "0");
+  // LVGL and SDK sources compiled as this many unity files each, 0 for none
+  // (see unity_build.cmake)
+  m_buildEnvironment.insert(
+      "LCD_UNITY_BUILD",
+      QString::number(
+          std::max(0, QSettings().value("build/unityBuild", 0).toInt())));
+  // -ftime-report for the build profile. ccache would replay the report of
+  // the build that filled the cache, so it is bypassed while this is on.
+  const bool timeReport = BuildProfiler::timeReportEnabled();
+  m_buildEnvironment.insert("LCD_TIME_REPORT", timeReport ? "1" : "0");
+  if (timeReport) {
+    m_buildEnvironment.insert("CCACHE_DISABLE", "1");
+  }
+  // Sized when the build starts, since the free memory changes
+  m_buildJobs = BuildJobs::plan();
+  BuildJobs::configure(m_buildJobs, m_buildEnvironment);
+  qDebug() << BuildJobs::describe(m_buildJobs);
+  // Where this build's steps start in .ninja_log, for recordBuild()
+  m_ninjaLogStart = NinjaLog::position(buildMcuDir() + "/.ninja_log");
+  m_buildProfiler.begin();
+  m_unityFallback = 0;
+  m_configuredEnvironment = configuredEnvironment();
+
+  if (m_imageDataOnly &&
+      QSettings().value("build/relinkFastPath", true).toBool() &&
+      QSettings().value("build/configuredEnvironment").toString() ==
+          m_configuredEnvironment &&
+      canRelink()) {
+    startRelink();
+  } else {
+    startConfigureScript();
+  }
+}
 
-  QString output = configureProcess.readAllStandardOutput();
-  QString error = configureProcess.readAllStandardError();
-
-  qDebug() << "Configure and build output:" << output;
-  if (!error.isEmpty()) {
-    qDebug() << "Configure and build errors:" << error;
+QString LVGLScriptRunner::configuredEnvironment() const {
+  // Everything the app passes that ends up in configure.stamp
+  QStringList values;
+  for (const char *name :
+       {"LCD_BUILD_TYPE", "LCD_FIRMWARE_LTO", "LCD_COMPILER_LAUNCHER",
+        "LCD_PREBUILT_LIBRARIES", "LCD_UNITY_BUILD", "LCD_TIME_REPORT"}) {
+    values << m_buildEnvironment.value(name);
   }
+  return values.join('|');
+}
 
-  if (configureProcess.exitCode() != 0) {
-    qDebug() << "Configure and build process failed with exit code:"
-             << configureProcess.exitCode();
+bool LVGLScriptRunner::canRelink() const {
+  // The last configure must have seen exactly the generated files there are
+  // now (generated_sources.stamp, written by the configure scripts), or the
+  // firmware would not link the blob object or would miss a source
+  const QDir buildDir(buildMcuDir());
+  QFile sourcesStamp(buildDir.filePath("generated_sources.stamp"));
+  if (!buildDir.exists("build.ninja") || !buildDir.exists("configure.stamp") ||
+      !sourcesStamp.open(QIODevice::ReadOnly | QIODevice::Text)) {
+    qDebug() << "Firmware build directory not configured, running the full "
+                "build";
     return false;
   }
-
-  // Build succeeded, automatically proceed to flash
-  if (!flashFirmware()) {
-    qDebug() << "Failed to flash the firmware. Make sure the device is connected and nrfjprog is available.";
+  QSet<QString> configured;
+  for (const QString &line :
+       QString::fromUtf8(sourcesStamp.readAll()).split('\n')) {
+    if (!line.trimmed().isEmpty()) {
+      configured.insert(line.trimmed());
+    }
+  }
+  const QStringList current =
+      QDir(buildDir.filePath("../generated"))
+          .entryList({"*.c", "*.o"}, QDir::Files | QDir::NoDotAndDotDot);
+  if (configured != QSet<QString>(current.begin(), current.end()) ||
+      !configured.contains("generated_images_blob.o")) {
+    qDebug() << "Generated files differ from the last configure, running the "
+                "full build";
     return false;
   }
-
   return true;
 }
 
-bool LVGLScriptRunner::flashFirmware() {
-  QString appDir = QApplication::applicationDirPath();
-  QString buildMcuDir = appDir + "/build_mcu";
-  QString hexFile = buildMcuDir + "/nrf52-lcd-tester-fw.hex";
+void LVGLScriptRunner::startRelink() {
+  // The configure script still compares configure.stamp (toolchain, SDK,
+  // LVGL and firmware versions) and exits with 3 if anything there changed.
+  // Otherwise ninja sees only the blob object newer than the firmware and
+  // reruns the link and hex steps; nothing is compiled.
+  qDebug() << "Only image data changed, relinking in:" << buildMcuDir();
+  QProcessEnvironment environment = m_buildEnvironment;
+  environment.insert("LCD_RELINK_ONLY", "1");
+  m_stage = Stage::Relink;
+  m_processRunner->setWorkingDirectory(buildMcuDir());
+  m_processRunner->setProcessEnvironment(environment);
+  m_processRunner->setProgressFormat(ProcessRunner::ProgressFormat::Ninja);
+  // An LTO link generates the code for the whole firmware, so this can take
+  // minutes as well
+  m_processRunner->setTimeouts(
+      QSettings().value("build/relinkTimeoutSeconds", 300).toInt() * 1000,
+      QSettings().value("build/idleTimeoutSeconds", 120).toInt() * 1000);
+  emit stageProgress("Linking", -1);
+#ifdef Q_OS_WIN
+  m_processRunner->start("cmd.exe", QStringList() << "/c" << "configure.bat");
+#else
+  m_processRunner->start("/bin/bash", QStringList() << "configure.sh");
+#endif
+}
+
+void LVGLScriptRunner::startConfigureScript() {
+  // Determine the configure script based on OS
+#ifdef Q_OS_WIN
+  const QString configureScript = buildMcuDir() + "/configure.bat";
+#else
+  const QString configureScript = buildMcuDir() + "/configure.sh";
+#endif
+
+  if (!QFile::exists(configureScript)) {
+    qDebug() << "Configure script not found at:" << configureScript;
+    finishProcessing(false, "Firmware configure script not found.");
+    return;
+  }
+
+  qDebug() << "Running configure script:" << configureScript;
+
+  // Configure and build both run in the script. The whole stage is capped,
+  // but a build that keeps printing ninja steps is never killed early; one
+  // that goes silent is.
+  m_stage = Stage::Build;
+  m_unityStepFailed = false;
+  m_processRunner->setWorkingDirectory(buildMcuDir());
+  m_processRunner->setProcessEnvironment(m_buildEnvironment);
+  m_processRunner->setProgressFormat(ProcessRunner::ProgressFormat::Ninja);
+  m_processRunner->setTimeouts(
+      QSettings().value("build/timeoutSeconds", 900).toInt() * 1000,
+      QSettings().value("build/idleTimeoutSeconds", 120).toInt() * 1000);
+  emit stageProgress("Building", -1);
+#ifdef Q_OS_WIN
+  m_processRunner->start("cmd.exe", QStringList() << "/c" << "configure.bat");
+#else
+  m_processRunner->start("/bin/bash", QStringList() << "configure.sh");
+#endif
+}
+
+void LVGLScriptRunner::startFlash() {
+  QString hexFile = buildMcuDir() + "/nrf52-lcd-tester-fw.hex";
 
   // Check if hex file exists
   if (!QFile::exists(hexFile)) {
     qDebug() << "Hex file not found at:" << hexFile;
-    return false;
+    finishProcessing(false, "Firmware hex file not found after the build.");
+    return;
   }
 
   // Convert to native path separators for the command line
@@ -362,40 +1176,211 @@ bool LVGLScriptRunner::flashFirmware() {
 
   qDebug() << "Flashing firmware from:" << nativeHexFile;
 
-  // Run nrfutil to flash the firmware
-  QProcess flashProcess;
-  flashProcess.start("nrfutil", QStringList()
-                                    << "device" << "program"
-                                    << "--firmware" << nativeHexFile
-                                    << "--options" << "chip_erase_mode=ERASE_ALL,verify=VERIFY_READ,reset=RESET_SYSTEM");
+  // Run nrfutil to flash the firmware. --json makes it report its progress
+  // as lines even though its output is not a terminal.
+  m_stage = Stage::Flash;
+  m_processRunner->setWorkingDirectory(buildMcuDir());
+  m_processRunner->setProcessEnvironment(
+      QProcessEnvironment::systemEnvironment());
+  m_processRunner->setProgressFormat(ProcessRunner::ProgressFormat::Nrfutil);
+  m_processRunner->setTimeouts(
+      QSettings().value("flash/timeoutSeconds", 120).toInt() * 1000,
+      QSettings().value("flash/idleTimeoutSeconds", 60).toInt() * 1000);
+  emit stageProgress("Flashing", -1);
+  m_processRunner->start("nrfutil", QStringList()
+                                        << "device" << "program"
+                                        << "--firmware" << nativeHexFile
+                                        << "--options" << "chip_erase_mode=ERASE_ALL,verify=VERIFY_READ,reset=RESET_SYSTEM"
+                                        << "--json");
+}
 
-  if (!flashProcess.waitForStarted()) {
-    qDebug()
-        << "Failed to start nrfutil. Make sure it's installed and in PATH.";
-    return false;
+void LVGLScriptRunner::onStageProgress(int percent) {
+  switch (m_stage) {
+  case Stage::Relink:
+    emit stageProgress("Linking", percent);
+    break;
+  case Stage::Build:
+    emit stageProgress("Building", percent);
+    break;
+  case Stage::Flash:
+    emit stageProgress("Flashing", percent);
+    break;
+  case Stage::Idle:
+    break;
   }
+}
 
-  if (!flashProcess.waitForFinished(60000)) { // 60 second timeout
-    qDebug() << "Flash process timed out";
-    flashProcess.kill();
-    return false;
+void LVGLScriptRunner::onStageFinished() {
+  // Copied: the next stage reuses the runner
+  const ProcessRunner::Result result = m_processRunner->result();
+  const Stage stage = m_stage;
+  m_stage = Stage::Idle;
+
+  if (!result.succeeded()) {
+    qDebug() << "Process failed after" << result.milliseconds
+             << "ms, exit code:" << result.exitCode << result.errorString;
   }
 
-  QString output = flashProcess.readAllStandardOutput();
-  QString error = flashProcess.readAllStandardError();
+  switch (stage) {
+  case Stage::Relink:
+    if (result.timedOut || result.canceled) {
+      // A full build would only run the same link again
+      finishProcessing(false, result.timedOut
+                                  ? QString("Firmware relink stopped: %1.")
+                                        .arg(result.errorString)
+                                  : QString("Firmware relink canceled."));
+      return;
+    }
+    if (!result.succeeded()) {
+      qDebug() << (result.exitCode == 3
+                       ? "Configuration changed, running the full build"
+                       : "Relink failed, running the full build");
+      startConfigureScript();
+      return;
+    }
+    m_stageTimings.append(QString("relink %1 ms").arg(result.milliseconds));
+    recordBuild("relink", result.milliseconds);
+    reportFirmwareSize();
+    emit processingProgress(
+        QString("Relinked the firmware with the new image data in %1 ms")
+            .arg(result.milliseconds));
+    startFlash();
+    return;
+
+  case Stage::Build: {
+    if (!result.succeeded() && m_unityStepFailed &&
+        m_buildEnvironment.value("LCD_UNITY_BUILD", "0") != "0") {
+      // Two sources of a unity file clash in a way unity_build.cmake cannot
+      // see. Turned off for good, or every upload would pay for a failed
+      // clean build first. Any other failure is reported as it is: changing
+      // the setting would cost a clean rebuild without fixing anything.
+      qDebug() << "Unity build failed, turning build/unityBuild off and "
+                  "building every source on its own";
+      m_unityFallback = m_buildEnvironment.value("LCD_UNITY_BUILD").toInt();
+      QSettings().setValue("build/unityBuild", 0);
+      m_buildEnvironment.insert("LCD_UNITY_BUILD", "0");
+      m_configuredEnvironment = configuredEnvironment();
+      startConfigureScript();
+      return;
+    }
+    if (!result.succeeded()) {
+      if (m_unityFallback > 0) {
+        // Not the unity build's fault then
+        QSettings().setValue("build/unityBuild", m_unityFallback);
+      }
+      finishProcessing(false,
+                       result.timedOut
+                           ? QString("Firmware build stopped: %1.")
+                                 .arg(result.errorString)
+                           : QString("Firmware build failed. Check the "
+                                     "console for details."));
+      return;
+    }
+    QSettings().setValue("build/configuredEnvironment",
+                         m_configuredEnvironment);
+    m_stageTimings.append(QString("build %1 ms").arg(result.milliseconds));
+    recordBuild("build", result.milliseconds);
+    reportFirmwareSize();
+
+    int hits = 0;
+    int misses = 0;
+    if (m_compilerCache && m_compilerCache->stats(hits, misses) &&
+        hits + misses > 0) {
+      const QString summary =
+          QString("Compiler cache: %1 hits, %2 misses (%3% hit rate)")
+              .arg(hits)
+              .arg(misses)
+              .arg(100.0 * hits / (hits + misses), 0, 'f', 1);
+      qDebug() << summary;
+      emit processingProgress(summary);
+    }
+
+    // Build succeeded, automatically proceed to flash
+    startFlash();
+    return;
+  }
 
-  qDebug() << "Flash output:" << output;
-  if (!error.isEmpty()) {
-    qDebug() << "Flash errors:" << error;
+  case Stage::Flash:
+    if (!result.succeeded()) {
+      finishProcessing(
+          false, result.started
+                     ? QString("Failed to flash the firmware (%1). Make sure "
+                               "the device is connected.")
+                           .arg(result.timedOut ? result.errorString
+                                                : QString("exit code %1")
+                                                      .arg(result.exitCode))
+                     : QString("Failed to start nrfutil. Make sure it's "
+                               "installed and in PATH."));
+      return;
+    }
+    m_stageTimings.append(QString("flash %1 ms").arg(result.milliseconds));
+    qDebug() << "Firmware has been successfully flashed to the nRF52 device!";
+    finishProcessing(
+        true, "Firmware has been successfully flashed to the nRF52 device!");
+    return;
+
+  case Stage::Idle:
+    return;
   }
+}
 
-  if (flashProcess.exitCode() != 0) {
-    qDebug() << "Flash process failed with exit code:"
-             << flashProcess.exitCode();
-    return false;
+void LVGLScriptRunner::recordBuild(const QString &kind, qint64 milliseconds) {
+  const QVector<NinjaLog::Entry> entries =
+      NinjaLog::lastRun(buildMcuDir() + "/.ninja_log", m_ninjaLogStart);
+  const BuildProfiler::Build profile =
+      m_buildProfiler.finish(kind, entries, milliseconds);
+  const NinjaLog::Concurrency stats = NinjaLog::concurrency(entries);
+  if (stats.steps == 0) {
+    qDebug() << "Build jobs: nothing was rebuilt";
+    return;
+  }
+  // An average well below -j means the build is bound by something else
+  // (a long link, the configure step, I/O), not by the job count
+  qDebug() << QString("Build jobs: %1 steps in %2 ms with -j%3, %4 running "
+                      "on average, %5 at peak, %6 ms of compiler time")
+                  .arg(stats.steps)
+                  .arg(stats.wallMs)
+                  .arg(m_buildJobs.jobs)
+                  .arg(stats.average(), 0, 'f', 2)
+                  .arg(stats.peak)
+                  .arg(stats.busyMs);
+
+  // The full table is in the build profile dialog
+  QStringList slowest;
+  for (int i = 0; i < std::min(5, int(profile.steps.size())); ++i) {
+    slowest << QString("%1 %2 ms")
+                   .arg(BuildProfiler::displayName(profile.steps[i].output))
+                   .arg(profile.steps[i].ms);
   }
+  qDebug().noquote() << "Slowest build steps:" << slowest.join(", ");
+}
 
-  qDebug() << "Firmware has been successfully flashed to the nRF52 device!";
+void LVGLScriptRunner::reportFirmwareSize() {
+  QString error;
+  const qint64 bytes = FlashPlanner::hexFlashBytes(
+      buildMcuDir() + "/nrf52-lcd-tester-fw.hex", error);
+  if (bytes < 0) {
+    qDebug() << "Could not read the firmware size:" << error;
+    return;
+  }
+  const QString type = buildType(m_firmwareProfile);
+  QSettings().setValue("firmware/flashBytes/" + type, bytes);
+  const QString summary = QString("Firmware (%1) takes %2 of flash")
+                              .arg(type)
+                              .arg(FlashPlanner::formatBytes(bytes));
+  qDebug() << summary;
+  emit processingProgress(summary);
+  emit firmwareBuilt(m_firmwareProfile, bytes);
+}
 
-  return true;
+void LVGLScriptRunner::finishProcessing(bool success, const QString &message) {
+  m_stage = Stage::Idle;
+  if (success) {
+    const QString summary = QString("Upload took %1 ms (%2)")
+                                .arg(m_uploadTimer.elapsed())
+                                .arg(m_stageTimings.join(", "));
+    qDebug() << summary;
+    emit processingProgress(summary);
+  }
+  emit processingCompleted(success, message);
 }
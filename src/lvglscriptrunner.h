@@ -1,39 +1,132 @@
 #pragma once
 
+#include "buildjobs.h"
+#include "buildprofiler.h"
+#include "lvglimageconverter.h"
+#include <QElapsedTimer>
 #include <QObject>
+#include <QProcessEnvironment>
 #include <QString>
 #include <QStringList>
 #include <QWidget>
 #include <QFutureWatcher>
 
+class CompilerCache;
+class ConversionCache;
 class EmbeddedPython;
+class ProcessRunner;
+class QThreadPool;
 
 class LVGLScriptRunner : public QObject {
   Q_OBJECT
 
 public:
+  // How converted pixel data reaches the firmware: one hex-literal C array per
+  // image, a single generated_images.bin linked in as an object made with
+  // objcopy, or a pool of tiles shared between images that the firmware
+  // composites (see TilePool).
+  enum class OutputMode { CArrays, BinaryBlob, Tiled };
+  // How the firmware is compiled. Release (-O2) and MinSize (-Os) also drop
+  // unused sections, and use LTO with build/lto (see
+  // toolchain-arm-none-eabi.cmake).
+  enum class FirmwareProfile { Debug, Release, MinSize };
+
   explicit LVGLScriptRunner(QWidget *parent = nullptr);
   ~LVGLScriptRunner();
 
   void processImagesAsync(const QStringList &imagePaths, const QString &outputDir);
   void setBrightness(int percent);
+  void setMaxConversionThreads(int threads);
+  void setOutputMode(OutputMode mode);
+  void setFirmwareProfile(FirmwareProfile profile);
+  // CMAKE_BUILD_TYPE for the profile
+  static QString buildType(FirmwareProfile profile);
+  // Flash the last firmware built with the profile takes, or -1 if it has
+  // not been built yet
+  static qint64 lastFirmwareBytes(FirmwareProfile profile);
+  void setDither(LVGLImageConverter::Dither dither);
+  // Row/data alignment in bytes and linker section for the image data; both
+  // are also written to generated_config.h for the firmware's render path.
+  void setImageAlignment(int bytes);
+  void setImageSection(const QString &section);
+  // Writes RGB565 images in SPI wire order; see LCD_IMAGES_PRESWAPPED
+  void setSwapBytes(bool swap);
+  // Per-image color format, in the same order as the paths passed to
+  // processImagesAsync(). Missing entries default to RGB565.
+  void setColorFormats(const QList<LVGLImageConverter::ColorFormat> &formats);
+  // Per-image compression, same order. Missing entries are left uncompressed.
+  void
+  setCompressions(const QList<LVGLImageConverter::Compression> &compressions);
 
 signals:
   void processingCompleted(bool success, const QString &message);
   void processingProgress(const QString &status);
+  // Current stage ("Converting", "Building", "Linking", "Flashing") and its
+  // percentage, -1 until the tool reports one
+  void stageProgress(const QString &stage, int percent);
+  // After every successful build or relink, with the flash the hex programs
+  void firmwareBuilt(FirmwareProfile profile, qint64 flashBytes);
 
 private:
   bool processImages(const QStringList &imagePaths, const QString &outputDir);
   QString getLibrariesPath();
   QString getLVGLScriptPath();
   bool ensurePythonReady();
-  bool configureAndBuildMCU();
-  bool flashFirmware();
+  bool runLVGLScript(const QString &imagePath, const QString &outputDir,
+                     const QString &name, const QString &colorFormat,
+                     const QString &compression, QString &output,
+                     QString &error);
+  // Firmware stages after the conversion, chained on the GUI thread through
+  // m_processRunner: relink (when only image data changed) or the configure
+  // script, then nrfutil. Each ends in onStageFinished().
+  enum class Stage { Idle, Relink, Build, Flash };
+  QString buildMcuDir() const;
+  void startBuild();
+  // The build settings the firmware build directory was configured with, as
+  // stored in build/configuredEnvironment
+  QString configuredEnvironment() const;
+  bool canRelink() const;
+  void startRelink();
+  void startConfigureScript();
+  void startFlash();
+  void onStageProgress(int percent);
+  void onStageFinished();
+  // Reads this build's steps from .ninja_log, logs how well the jobs were
+  // used and records the build profile
+  void recordBuild(const QString &kind, qint64 milliseconds);
+  void reportFirmwareSize();
+  void finishProcessing(bool success, const QString &message);
 
   void onProcessingFinished();
 
   QWidget *m_parent;
   EmbeddedPython *m_embeddedPython;
   QFutureWatcher<bool> *m_futureWatcher;
+  QThreadPool *m_conversionPool;
+  ConversionCache *m_conversionCache;
+  // Null when disabled with build/compilerCache=false
+  CompilerCache *m_compilerCache;
+  ProcessRunner *m_processRunner;
+  Stage m_stage = Stage::Idle;
+  // Set by processImages(): nothing the firmware compiles changed, so
+  // relinking is enough
+  bool m_imageDataOnly = false;
+  QProcessEnvironment m_buildEnvironment;
+  BuildJobs::Plan m_buildJobs;
+  // .ninja_log before this build, so recordBuild() reads only its steps
+  NinjaLog::Position m_ninjaLogStart;
+  BuildProfiler m_buildProfiler;
+  // build/unityBuild before a failed unity build turned it off, 0 if none
+  int m_unityFallback = 0;
+  // A unity file was the step that failed in this run of the configure script
+  bool m_unityStepFailed = false;
+  QString m_configuredEnvironment;
+  QElapsedTimer m_uploadTimer;
+  QStringList m_stageTimings;
   int m_brightness = 50;
+  OutputMode m_outputMode = OutputMode::CArrays;
+  FirmwareProfile m_firmwareProfile = FirmwareProfile::Debug;
+  LVGLImageConverter::Options m_conversionOptions;
+  QList<LVGLImageConverter::ColorFormat> m_colorFormats;
+  QList<LVGLImageConverter::Compression> m_compressions;
 };
\ No newline at end of file
@@ -1,17 +1,28 @@
 #include "mainwindow.h"
+#include "buildprofiledialog.h"
 #include "imagedropwidget.h"
+#include "imageimportdialog.h"
 #include "imagepreviewwidget.h"
 #include "lvglscriptrunner.h"
 #include "startupchecker.h"
 #include <QApplication>
+#include <QCryptographicHash>
+#include <QDebug>
+#include <QDir>
 #include <QFileInfo>
+#include <QImageReader>
 #include <QPixmap>
 #include <QSettings>
+#include <QStandardPaths>
+#include <algorithm>
+#include <cstdlib>
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent), m_centralWidget(nullptr), m_dropWidget(nullptr),
-      m_counterLabel(nullptr), m_brightnessSlider(nullptr),
-      m_brightnessValueLabel(nullptr), m_scrollArea(nullptr),
+      m_counterLabel(nullptr), m_flashBudgetSpin(nullptr),
+      m_brightnessSlider(nullptr),
+      m_brightnessValueLabel(nullptr), m_outputModeCombo(nullptr),
+      m_ditherCombo(nullptr), m_scrollArea(nullptr),
       m_imagesWidget(nullptr), m_imagesLayout(nullptr), m_flashButton(nullptr),
       m_startupChecker(nullptr), m_scriptRunner(nullptr) {
   QString title = "LCD GUI Tester";
@@ -30,6 +41,10 @@ MainWindow::MainWindow(QWidget *parent)
           this, &MainWindow::onProcessingCompleted);
   connect(m_scriptRunner, &LVGLScriptRunner::processingProgress,
           this, &MainWindow::onProcessingProgress);
+  connect(m_scriptRunner, &LVGLScriptRunner::stageProgress,
+          this, &MainWindow::onStageProgress);
+  connect(m_scriptRunner, &LVGLScriptRunner::firmwareBuilt,
+          this, [this]() { updateFirmwareSize(); });
 
   // Perform comprehensive startup check
   if (!m_startupChecker->performStartupCheck()) {
@@ -61,10 +76,29 @@ void MainWindow::setupUI() {
   m_dropWidget = new ImageDropWidget(this);
   mainLayout->addWidget(m_dropWidget);
 
-  // Image counter
-  m_counterLabel = new QLabel(QString("Images: 0/%1").arg(MAX_IMAGES));
+  // Image counter and the flash budget images are planned against
+  auto counterRow = new QHBoxLayout;
+  m_counterLabel = new QLabel("Images: 0");
   m_counterLabel->setStyleSheet("font-weight: bold; margin: 10px;");
-  mainLayout->addWidget(m_counterLabel);
+
+  auto budgetLabel = new QLabel("Flash budget:");
+  m_flashBudgetSpin = new QSpinBox;
+  m_flashBudgetSpin->setRange(16, 1024);
+  m_flashBudgetSpin->setSingleStep(16);
+  m_flashBudgetSpin->setSuffix(" KB");
+  m_flashBudgetSpin->setValue(
+      QSettings().value("flash/budgetKB", DEFAULT_FLASH_BUDGET_KB).toInt());
+  m_flashBudgetSpin->setToolTip(
+      "Flash left for image data once the firmware is linked");
+
+  counterRow->addWidget(m_counterLabel, 1);
+  counterRow->addWidget(budgetLabel);
+  counterRow->addWidget(m_flashBudgetSpin);
+  counterRow->addSpacing(10);
+  mainLayout->addLayout(counterRow);
+
+  connect(m_flashBudgetSpin, QOverload<int>::of(&QSpinBox::valueChanged),
+          this, &MainWindow::onFlashBudgetChanged);
 
   // Brightness slider (applied on next UPLOAD via generated_config.h)
   const int initialBrightness =
@@ -91,6 +125,133 @@ void MainWindow::setupUI() {
   connect(m_brightnessSlider, &QSlider::valueChanged,
           this, &MainWindow::onBrightnessChanged);
 
+  // Image data packaging: C arrays compile every pixel as a hex literal, the
+  // binary blob is linked in as-is and builds much faster, and tiled output
+  // stores regions shared between images once.
+  auto outputModeRow = new QHBoxLayout;
+  auto outputModeLabel = new QLabel("Image data:");
+  outputModeLabel->setStyleSheet("font-weight: bold; margin-left: 10px;");
+
+  m_outputModeCombo = new QComboBox;
+  m_outputModeCombo->addItem(
+      "C arrays", static_cast<int>(LVGLScriptRunner::OutputMode::CArrays));
+  m_outputModeCombo->addItem(
+      "Binary blob", static_cast<int>(LVGLScriptRunner::OutputMode::BinaryBlob));
+  m_outputModeCombo->addItem(
+      "Tiled (shared tiles)",
+      static_cast<int>(LVGLScriptRunner::OutputMode::Tiled));
+  m_outputModeCombo->setCurrentIndex(m_outputModeCombo->findData(
+      QSettings().value("output/mode", 0).toInt()));
+
+  outputModeRow->addWidget(outputModeLabel);
+  outputModeRow->addWidget(m_outputModeCombo, 1);
+  outputModeRow->addSpacing(10);
+  mainLayout->addLayout(outputModeRow);
+
+  connect(m_outputModeCombo,
+          QOverload<int>::of(&QComboBox::currentIndexChanged),
+          this, &MainWindow::onOutputModeChanged);
+
+  // Dithering hides RGB565 banding on gradients
+  auto ditherRow = new QHBoxLayout;
+  auto ditherLabel = new QLabel("Dithering:");
+  ditherLabel->setStyleSheet("font-weight: bold; margin-left: 10px;");
+
+  m_ditherCombo = new QComboBox;
+  m_ditherCombo->addItem(
+      "None", static_cast<int>(LVGLImageConverter::Dither::None));
+  m_ditherCombo->addItem(
+      "Ordered (Bayer)", static_cast<int>(LVGLImageConverter::Dither::Ordered));
+  m_ditherCombo->addItem(
+      "Floyd-Steinberg",
+      static_cast<int>(LVGLImageConverter::Dither::FloydSteinberg));
+  m_ditherCombo->setCurrentIndex(m_ditherCombo->findData(
+      QSettings().value("conversion/dither", 0).toInt()));
+
+  ditherRow->addWidget(ditherLabel);
+  ditherRow->addWidget(m_ditherCombo, 1);
+  ditherRow->addSpacing(10);
+  mainLayout->addLayout(ditherRow);
+
+  connect(m_ditherCombo, QOverload<int>::of(&QComboBox::currentIndexChanged),
+          this, &MainWindow::onDitherChanged);
+
+  // Row and data alignment plus linker section, for DMA-friendly layouts
+  auto layoutRow = new QHBoxLayout;
+  auto layoutLabel = new QLabel("Data layout:");
+  layoutLabel->setStyleSheet("font-weight: bold; margin-left: 10px;");
+
+  m_alignmentCombo = new QComboBox;
+  m_alignmentCombo->addItem("Packed rows", 1);
+  for (int bytes : {4, 8, 16, 32, 64}) {
+    m_alignmentCombo->addItem(QString("%1-byte aligned").arg(bytes), bytes);
+  }
+  m_alignmentCombo->setCurrentIndex(m_alignmentCombo->findData(
+      QSettings().value("output/alignment", 1).toInt()));
+
+  m_sectionEdit = new QLineEdit(QSettings().value("output/section").toString());
+  m_sectionEdit->setPlaceholderText(".rodata");
+  m_sectionEdit->setToolTip("Linker section for the image data, e.g. a "
+                            "section your linker script places in RAM");
+
+  layoutRow->addWidget(layoutLabel);
+  layoutRow->addWidget(m_alignmentCombo, 1);
+  layoutRow->addWidget(m_sectionEdit, 1);
+
+  // ST7789-class panels take big-endian RGB565 over SPI
+  m_swapBytesCheck = new QCheckBox("Pre-swap RGB565");
+  m_swapBytesCheck->setChecked(
+      QSettings().value("output/preswap", false).toBool());
+  m_swapBytesCheck->setToolTip(
+      "Store RGB565 images in the panel's SPI byte order so the firmware "
+      "does not swap bytes on every flush");
+  layoutRow->addWidget(m_swapBytesCheck);
+  layoutRow->addSpacing(10);
+  mainLayout->addLayout(layoutRow);
+
+  connect(m_alignmentCombo,
+          QOverload<int>::of(&QComboBox::currentIndexChanged),
+          this, &MainWindow::onAlignmentChanged);
+  connect(m_sectionEdit, &QLineEdit::editingFinished,
+          this, &MainWindow::onSectionEdited);
+  connect(m_swapBytesCheck, &QCheckBox::toggled,
+          this, &MainWindow::onSwapBytesToggled);
+
+  // Compiler optimization for the firmware; the size of the last build with
+  // the selected profile is shown next to it
+  auto firmwareRow = new QHBoxLayout;
+  auto firmwareLabel = new QLabel("Firmware:");
+  firmwareLabel->setStyleSheet("font-weight: bold; margin-left: 10px;");
+
+  m_firmwareProfileCombo = new QComboBox;
+  m_firmwareProfileCombo->addItem(
+      "Debug", static_cast<int>(LVGLScriptRunner::FirmwareProfile::Debug));
+  m_firmwareProfileCombo->addItem(
+      "Release (-O2)",
+      static_cast<int>(LVGLScriptRunner::FirmwareProfile::Release));
+  m_firmwareProfileCombo->addItem(
+      "Smallest (-Os)",
+      static_cast<int>(LVGLScriptRunner::FirmwareProfile::MinSize));
+  m_firmwareProfileCombo->setCurrentIndex(std::max(
+      0, m_firmwareProfileCombo->findData(
+             QSettings().value("build/profile", 0).toInt())));
+  m_firmwareProfileCombo->setToolTip(
+      "Release and Smallest drop unused code and data, which makes the "
+      "image smaller and faster to flash");
+
+  m_firmwareSizeLabel = new QLabel;
+  m_firmwareSizeLabel->setStyleSheet("margin-right: 10px;");
+
+  firmwareRow->addWidget(firmwareLabel);
+  firmwareRow->addWidget(m_firmwareProfileCombo, 1);
+  firmwareRow->addWidget(m_firmwareSizeLabel, 1);
+  mainLayout->addLayout(firmwareRow);
+
+  connect(m_firmwareProfileCombo,
+          QOverload<int>::of(&QComboBox::currentIndexChanged),
+          this, &MainWindow::onFirmwareProfileChanged);
+  updateFirmwareSize();
+
   // Scroll area for images
   m_scrollArea = new QScrollArea;
   m_scrollArea->setWidgetResizable(true);
@@ -121,17 +282,28 @@ void MainWindow::setupUI() {
                                "}");
   m_flashButton->setEnabled(false);
   connect(m_flashButton, &QPushButton::clicked, this, &MainWindow::flashImages);
-  mainLayout->addWidget(m_flashButton);
+
+  // Where the firmware builds spent their time (see BuildProfiler)
+  m_buildProfileButton = new QPushButton("Build Profile...");
+  m_buildProfileButton->setToolTip(
+      "Show the slowest compile and link steps of recent firmware builds");
+  connect(m_buildProfileButton, &QPushButton::clicked, this,
+          &MainWindow::showBuildProfile);
+
+  auto flashRow = new QHBoxLayout;
+  flashRow->addWidget(m_flashButton, 1);
+  flashRow->addWidget(m_buildProfileButton);
+  mainLayout->addLayout(flashRow);
 }
 
-void MainWindow::addImage(const QString &imagePath) {
-  if (m_images.size() >= MAX_IMAGES) {
-    QMessageBox::warning(this, "Error",
-                         QString("Maximum %1 images allowed!").arg(MAX_IMAGES));
-    return;
-  }
+void MainWindow::showBuildProfile() {
+  BuildProfileDialog dialog(this);
+  dialog.exec();
+}
 
-  if (!validateImageSize(imagePath)) {
+void MainWindow::addImage(const QString &path) {
+  QString imagePath = path;
+  if (!importImage(imagePath)) {
     return;
   }
 
@@ -143,10 +315,31 @@ void MainWindow::addImage(const QString &imagePath) {
     }
   }
 
-  // Add image
+  // Add image if it fits what the others leave of the budget
   ImageInfo imageInfo;
   imageInfo.path = imagePath;
   imageInfo.index = m_images.size();
+
+  // Planned first: it drops what is cached for files not in m_images yet
+  const qint64 remaining = updateFlashBudget();
+  QString error;
+  imageInfo.flashBytes = m_flashPlanner.imageBytes(
+      imagePath, conversionOptions(imageInfo), error);
+  if (imageInfo.flashBytes < 0) {
+    QMessageBox::critical(this, "Error", error);
+    return;
+  }
+
+  if (imageInfo.flashBytes > remaining) {
+    QMessageBox::warning(
+        this, "Flash Budget Exceeded",
+        QString("This image needs %1 of flash but only %2 is left.\n"
+                "Pick a smaller format or compression for the other images, "
+                "or raise the flash budget.")
+            .arg(FlashPlanner::formatBytes(imageInfo.flashBytes))
+            .arg(FlashPlanner::formatBytes(std::max<qint64>(remaining, 0))));
+    return;
+  }
   m_images.append(imageInfo);
 
   updateUI();
@@ -165,6 +358,22 @@ void MainWindow::removeImage(int index) {
   }
 }
 
+void MainWindow::setImageColorFormat(int index,
+                                     LVGLImageConverter::ColorFormat format) {
+  if (index >= 0 && index < m_images.size()) {
+    m_images[index].colorFormat = format;
+    updateFlashBudget();
+  }
+}
+
+void MainWindow::setImageCompression(
+    int index, LVGLImageConverter::Compression compression) {
+  if (index >= 0 && index < m_images.size()) {
+    m_images[index].compression = compression;
+    updateFlashBudget();
+  }
+}
+
 void MainWindow::updateUI() {
   // Clear current layout
   QLayoutItem *child;
@@ -176,42 +385,118 @@ void MainWindow::updateUI() {
   // Add image previews
   for (int i = 0; i < m_images.size(); ++i) {
     const ImageInfo &imageInfo = m_images[i];
-    auto preview = new ImagePreviewWidget(imageInfo.path, i, this);
+    auto preview = new ImagePreviewWidget(imageInfo.path, i,
+                                          imageInfo.colorFormat,
+                                          imageInfo.compression, this);
     int row = i / 4;
     int col = i % 4;
     m_imagesLayout->addWidget(preview, row, col);
   }
 
-  // Update counter
-  m_counterLabel->setText(
-      QString("Images: %1/%2").arg(m_images.size()).arg(MAX_IMAGES));
+  updateFlashBudget();
+}
 
-  // Enable/disable flash button
-  m_flashButton->setEnabled(!m_images.isEmpty());
+LVGLImageConverter::Options
+MainWindow::conversionOptions(const ImageInfo &imageInfo) const {
+  LVGLImageConverter::Options options;
+  options.colorFormat = imageInfo.colorFormat;
+  options.compression = imageInfo.compression;
+  options.dither = static_cast<LVGLImageConverter::Dither>(
+      m_ditherCombo->currentData().toInt());
+  options.alignment = m_alignmentCombo->currentData().toInt();
+  options.swapBytes = m_swapBytesCheck->isChecked();
+  return options;
 }
 
-bool MainWindow::validateImageSize(const QString &imagePath) {
-  QPixmap pixmap(imagePath);
-  if (pixmap.isNull()) {
+qint64 MainWindow::updateFlashBudget() {
+  // Removed and since modified images are not planned again
+  QStringList paths;
+  for (const ImageInfo &imageInfo : m_images) {
+    paths.append(imageInfo.path);
+  }
+  m_flashPlanner.retain(paths);
+
+  qint64 used = 0;
+  bool plannable = true;
+  for (ImageInfo &imageInfo : m_images) {
+    QString error;
+    imageInfo.flashBytes = m_flashPlanner.imageBytes(
+        imageInfo.path, conversionOptions(imageInfo), error);
+    if (imageInfo.flashBytes < 0) {
+      qWarning() << "Cannot plan flash for" << imageInfo.path << ":" << error;
+      plannable = false;
+      continue;
+    }
+    used += imageInfo.flashBytes;
+  }
+
+  const qint64 budget = qint64(m_flashBudgetSpin->value()) * 1024;
+  const qint64 remaining = budget - used;
+  m_counterLabel->setText(
+      QString("Images: %1 - %2 used, %3 %4")
+          .arg(m_images.size())
+          .arg(FlashPlanner::formatBytes(used))
+          .arg(FlashPlanner::formatBytes(std::abs(remaining)))
+          .arg(remaining < 0 ? "over budget" : "left"));
+  m_counterLabel->setStyleSheet(
+      remaining < 0 ? "font-weight: bold; margin: 10px; color: #c42b1c;"
+                    : "font-weight: bold; margin: 10px;");
+
+  // Enable/disable flash button; an over-budget set would not link
+  if (!m_processing) {
+    m_flashButton->setEnabled(!m_images.isEmpty() && plannable &&
+                              remaining >= 0);
+  }
+  return remaining;
+}
+
+bool MainWindow::importImage(QString &imagePath) {
+  QImageReader reader(imagePath);
+  if (!reader.canRead()) {
     QMessageBox::critical(this, "Error",
                           QString("Failed to load image: %1").arg(imagePath));
     return false;
   }
 
-  int width = pixmap.width();
-  int height = pixmap.height();
-
-  if (width != REQUIRED_WIDTH || height != REQUIRED_HEIGHT) {
-    QMessageBox::critical(this, "Invalid Image Size",
-                          QString("Image must be exactly %1x%2 pixels!\n"
-                                  "Current image is %3x%4 pixels.")
-                              .arg(REQUIRED_WIDTH)
-                              .arg(REQUIRED_HEIGHT)
-                              .arg(width)
-                              .arg(height));
+  // Most formats report their size from the header without decoding
+  const QSize targetSize(REQUIRED_WIDTH, REQUIRED_HEIGHT);
+  QSize size = reader.size();
+  if (!size.isValid()) {
+    size = reader.read().size();
+  }
+  if (size == targetSize) {
+    return true;
+  }
+
+  ImageImportDialog dialog(imagePath, targetSize, this);
+  if (dialog.exec() != QDialog::Accepted) {
+    return false;
+  }
+
+  // The fitted copy is keyed by its pixels, so importing the same result
+  // twice resolves to the same path and is caught as a duplicate.
+  const QImage fitted = dialog.result();
+  const QByteArray hash =
+      QCryptographicHash::hash(
+          QByteArray::fromRawData(
+              reinterpret_cast<const char *>(fitted.constBits()),
+              fitted.sizeInBytes()),
+          QCryptographicHash::Sha1)
+          .toHex()
+          .left(12);
+  const QString dir =
+      QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) +
+      "/imports/" + QString::fromLatin1(hash);
+  const QString fittedPath =
+      dir + "/" + QFileInfo(imagePath).completeBaseName() + ".png";
+  if (!QDir().mkpath(dir) || !fitted.save(fittedPath, "PNG")) {
+    QMessageBox::critical(
+        this, "Error",
+        QString("Failed to save the fitted image to %1").arg(fittedPath));
     return false;
   }
 
+  imagePath = fittedPath;
   return true;
 }
 
@@ -221,13 +506,18 @@ void MainWindow::flashImages() {
   }
 
   // Disable flash button during processing
+  m_processing = true;
   m_flashButton->setEnabled(false);
   m_flashButton->setText("PROCESSING...");
 
   // Prepare image paths
   QStringList imagePaths;
+  QList<LVGLImageConverter::ColorFormat> colorFormats;
+  QList<LVGLImageConverter::Compression> compressions;
   for (const ImageInfo &imageInfo : m_images) {
     imagePaths.append(imageInfo.path);
+    colorFormats.append(imageInfo.colorFormat);
+    compressions.append(imageInfo.compression);
   }
 
   // Create output directory
@@ -235,6 +525,18 @@ void MainWindow::flashImages() {
   QString outputDir = appDir + "/generated";
 
   m_scriptRunner->setBrightness(m_brightnessSlider->value());
+  m_scriptRunner->setOutputMode(static_cast<LVGLScriptRunner::OutputMode>(
+      m_outputModeCombo->currentData().toInt()));
+  m_scriptRunner->setDither(static_cast<LVGLImageConverter::Dither>(
+      m_ditherCombo->currentData().toInt()));
+  m_scriptRunner->setImageAlignment(m_alignmentCombo->currentData().toInt());
+  m_scriptRunner->setImageSection(m_sectionEdit->text().trimmed());
+  m_scriptRunner->setSwapBytes(m_swapBytesCheck->isChecked());
+  m_scriptRunner->setFirmwareProfile(
+      static_cast<LVGLScriptRunner::FirmwareProfile>(
+          m_firmwareProfileCombo->currentData().toInt()));
+  m_scriptRunner->setColorFormats(colorFormats);
+  m_scriptRunner->setCompressions(compressions);
 
   // Process images asynchronously with embedded Python and LVGL script
   m_scriptRunner->processImagesAsync(imagePaths, outputDir);
@@ -245,10 +547,62 @@ void MainWindow::onBrightnessChanged(int value) {
   QSettings().setValue("display/brightness", value);
 }
 
+void MainWindow::onOutputModeChanged(int index) {
+  QSettings().setValue("output/mode", m_outputModeCombo->itemData(index));
+}
+
+void MainWindow::onDitherChanged(int index) {
+  QSettings().setValue("conversion/dither", m_ditherCombo->itemData(index));
+  updateFlashBudget();
+}
+
+void MainWindow::onAlignmentChanged(int index) {
+  QSettings().setValue("output/alignment", m_alignmentCombo->itemData(index));
+  updateFlashBudget();
+}
+
+void MainWindow::onSectionEdited() {
+  QSettings().setValue("output/section", m_sectionEdit->text().trimmed());
+}
+
+void MainWindow::onSwapBytesToggled(bool checked) {
+  QSettings().setValue("output/preswap", checked);
+  updateFlashBudget();
+}
+
+void MainWindow::onFirmwareProfileChanged(int index) {
+  QSettings().setValue("build/profile",
+                       m_firmwareProfileCombo->itemData(index));
+  updateFirmwareSize();
+}
+
+void MainWindow::updateFirmwareSize() {
+  const auto profile = static_cast<LVGLScriptRunner::FirmwareProfile>(
+      m_firmwareProfileCombo->currentData().toInt());
+  const qint64 bytes = LVGLScriptRunner::lastFirmwareBytes(profile);
+  if (bytes < 0) {
+    m_firmwareSizeLabel->setText("Flash: not built yet");
+    return;
+  }
+  QString text = QString("Flash: %1").arg(FlashPlanner::formatBytes(bytes));
+  const qint64 debugBytes = LVGLScriptRunner::lastFirmwareBytes(
+      LVGLScriptRunner::FirmwareProfile::Debug);
+  if (profile != LVGLScriptRunner::FirmwareProfile::Debug && debugBytes > 0) {
+    text += QString(" (%1% of Debug)").arg(100 * bytes / debugBytes);
+  }
+  m_firmwareSizeLabel->setText(text);
+}
+
+void MainWindow::onFlashBudgetChanged(int kilobytes) {
+  QSettings().setValue("flash/budgetKB", kilobytes);
+  updateFlashBudget();
+}
+
 void MainWindow::onProcessingCompleted(bool success, const QString &message) {
   // Re-enable flash button
-  m_flashButton->setEnabled(true);
+  m_processing = false;
   m_flashButton->setText("UPLOAD");
+  updateFlashBudget();
 
   if (!success) {
     QMessageBox::critical(this, "Error", message);
@@ -259,3 +613,12 @@ void MainWindow::onProcessingProgress(const QString &status) {
   // Optional: Update status bar or similar
   statusBar()->showMessage(status, 3000);
 }
+
+void MainWindow::onStageProgress(const QString &stage, int percent) {
+  if (!m_processing) {
+    return;
+  }
+  m_flashButton->setText(percent >= 0
+                             ? QString("%1 %2%").arg(stage.toUpper()).arg(percent)
+                             : stage.toUpper() + "...");
+}
@@ -1,13 +1,17 @@
 #pragma once
 
 #include <QMainWindow>
+#include <QCheckBox>
+#include <QComboBox>
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QGridLayout>
 #include <QLabel>
+#include <QLineEdit>
 #include <QPushButton>
 #include <QScrollArea>
 #include <QSlider>
+#include <QSpinBox>
 #include <QWidget>
 #include <QFrame>
 #include <QMessageBox>
@@ -20,6 +24,8 @@
 #include <QVector>
 #include <QFileInfo>
 #include <QStatusBar>
+#include "flashplanner.h"
+#include "lvglimageconverter.h"
 
 class StartupChecker;
 class LVGLScriptRunner;
@@ -30,6 +36,10 @@ class ImagePreviewWidget;
 struct ImageInfo {
     QString path;
     int index;
+    LVGLImageConverter::ColorFormat colorFormat = LVGLImageConverter::ColorFormat::RGB565;
+    LVGLImageConverter::Compression compression = LVGLImageConverter::Compression::None;
+    // Planned flash use with the current options, -1 if it could not be encoded
+    qint64 flashBytes = -1;
 };
 
 class MainWindow : public QMainWindow
@@ -42,19 +52,40 @@ public:
 
     void addImage(const QString& imagePath);
     void removeImage(int index);
+    void setImageColorFormat(int index, LVGLImageConverter::ColorFormat format);
+    void setImageCompression(int index, LVGLImageConverter::Compression compression);
 
 private slots:
     void flashImages();
     void onProcessingCompleted(bool success, const QString &message);
     void onProcessingProgress(const QString &status);
+    void onStageProgress(const QString &stage, int percent);
     void onBrightnessChanged(int value);
+    void onOutputModeChanged(int index);
+    void onDitherChanged(int index);
+    void onAlignmentChanged(int index);
+    void onSectionEdited();
+    void onSwapBytesToggled(bool checked);
+    void onFlashBudgetChanged(int kilobytes);
+    void onFirmwareProfileChanged(int index);
+    void showBuildProfile();
 
 private:
     void setupUI();
     void updateUI();
-    bool validateImageSize(const QString& imagePath);
+    // Passes panel-sized images through; anything else goes through
+    // ImageImportDialog and `imagePath` becomes the fitted copy.
+    bool importImage(QString& imagePath);
+    LVGLImageConverter::Options conversionOptions(const ImageInfo& imageInfo) const;
+    // Re-plans every image against the budget and updates the counter and
+    // UPLOAD button; returns the bytes still free (negative when over)
+    qint64 updateFlashBudget();
+    // Shows the flash the last build with the selected firmware profile took
+    void updateFirmwareSize();
 
-    static constexpr int MAX_IMAGES = 5;
+    // Default flash left for images on the nRF52 once the firmware is
+    // linked; fits the five raw RGB565 screens the old fixed limit allowed
+    static constexpr int DEFAULT_FLASH_BUDGET_KB = 540;
     static constexpr int REQUIRED_WIDTH = 170;
     static constexpr int REQUIRED_HEIGHT = 320;
     static constexpr int DEFAULT_BRIGHTNESS = 50;
@@ -62,14 +93,25 @@ private:
     QWidget *m_centralWidget;
     ImageDropWidget *m_dropWidget;
     QLabel *m_counterLabel;
+    QSpinBox *m_flashBudgetSpin;
     QSlider *m_brightnessSlider;
     QLabel *m_brightnessValueLabel;
+    QComboBox *m_outputModeCombo;
+    QComboBox *m_ditherCombo;
+    QComboBox *m_alignmentCombo;
+    QLineEdit *m_sectionEdit;
+    QCheckBox *m_swapBytesCheck;
+    QComboBox *m_firmwareProfileCombo;
+    QLabel *m_firmwareSizeLabel;
     QScrollArea *m_scrollArea;
     QWidget *m_imagesWidget;
     QGridLayout *m_imagesLayout;
     QPushButton *m_flashButton;
+    QPushButton *m_buildProfileButton;
+    bool m_processing = false;
 
     QVector<ImageInfo> m_images;
+    FlashPlanner m_flashPlanner;
     StartupChecker* m_startupChecker;
     LVGLScriptRunner* m_scriptRunner;
 };
\ No newline at end of file
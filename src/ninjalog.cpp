@@ -0,0 +1,120 @@
+#include "ninjalog.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QPair>
+#include <algorithm>
+
+namespace NinjaLog {
+
+namespace {
+// The first line after the "# ninja log" header, from the start of `file`
+QByteArray firstLine(QFile &file) {
+  file.seek(0);
+  while (!file.atEnd()) {
+    const QByteArray line = file.readLine().trimmed();
+    if (!line.isEmpty() && !line.startsWith('#')) {
+      return line;
+    }
+  }
+  return {};
+}
+
+// Whether `from` still marks the end of a run in the log open in `file`
+bool continues(QFile &file, const Position &from) {
+  if (from.size <= 0 || from.size > file.size()) {
+    return false;
+  }
+  const QDateTime created = QFileInfo(file).birthTime();
+  if (from.created.isValid() && created.isValid() && from.created != created) {
+    return false;
+  }
+  if (firstLine(file) != from.firstLine) {
+    return false;
+  }
+  // A line boundary, not the middle of a line of some other file
+  char before = 0;
+  return file.seek(from.size - 1) && file.getChar(&before) && before == '\n';
+}
+} // namespace
+
+Position position(const QString &path) {
+  Position result;
+  QFile file(path);
+  if (!file.open(QIODevice::ReadOnly)) {
+    return result;
+  }
+  result.size = file.size();
+  result.firstLine = firstLine(file);
+  result.created = QFileInfo(file).birthTime();
+  return result;
+}
+
+QVector<Entry> lastRun(const QString &path, const Position &from) {
+  QFile file(path);
+  if (!file.open(QIODevice::ReadOnly)) {
+    return {};
+  }
+  if (!continues(file, from)) {
+    file.seek(0);
+  }
+
+  QVector<Entry> entries;
+  while (!file.atEnd()) {
+    const QByteArray line = file.readLine().trimmed();
+    if (line.isEmpty() || line.startsWith('#')) {
+      continue;
+    }
+    const QList<QByteArray> fields = line.split('\t');
+    if (fields.size() < 4) {
+      continue;
+    }
+    bool startOk = false;
+    bool endOk = false;
+    Entry entry;
+    entry.startMs = fields[0].toLongLong(&startOk);
+    entry.endMs = fields[1].toLongLong(&endOk);
+    entry.output = QString::fromUtf8(fields[3]);
+    if (!startOk || !endOk) {
+      continue;
+    }
+    // An earlier end than the step before means a new run began
+    if (!entries.isEmpty() && entry.endMs < entries.last().endMs) {
+      entries.clear();
+    }
+    entries.append(entry);
+  }
+  return entries;
+}
+
+Concurrency concurrency(const QVector<Entry> &entries) {
+  Concurrency result;
+  if (entries.isEmpty()) {
+    return result;
+  }
+
+  // +1 at every start, -1 at every end; ends sort first at equal times so
+  // back-to-back steps do not count as overlapping
+  QVector<QPair<qint64, int>> events;
+  events.reserve(entries.size() * 2);
+  qint64 first = entries.first().startMs;
+  qint64 last = entries.first().endMs;
+  for (const Entry &entry : entries) {
+    events.append({entry.startMs, 1});
+    events.append({entry.endMs, -1});
+    result.busyMs += entry.durationMs();
+    first = std::min(first, entry.startMs);
+    last = std::max(last, entry.endMs);
+  }
+  std::sort(events.begin(), events.end());
+  int running = 0;
+  for (const auto &event : events) {
+    running += event.second;
+    result.peak = std::max(result.peak, running);
+  }
+
+  result.steps = entries.size();
+  result.wallMs = last - first;
+  return result;
+}
+
+} // namespace NinjaLog
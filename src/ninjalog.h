@@ -0,0 +1,58 @@
+#pragma once
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QString>
+#include <QVector>
+
+// Reader for the .ninja_log that ninja keeps in the firmware build directory.
+//
+// Format v5 is one tab-separated line per finished step: start and end in
+// milliseconds since that ninja run began, the output's mtime, the output
+// path and a command hash. Steps are appended as they finish, so end times
+// only decrease where a new run starts.
+namespace NinjaLog {
+
+struct Entry {
+  qint64 startMs = 0;
+  qint64 endMs = 0;
+  QString output;
+
+  qint64 durationMs() const { return endMs - startMs; }
+};
+
+// Where the log ends, and which file it is. Ninja rewrites the log when it
+// recompacts it at the start of a run, and the configure scripts delete it
+// on a clean build, so the size alone can point into a different file.
+struct Position {
+  qint64 size = 0;
+  // The first step line, and the creation time where the file system has one
+  QByteArray firstLine;
+  QDateTime created;
+};
+
+// Taken before a build, for lastRun()
+Position position(const QString &path);
+
+// Steps of the most recent run, in the order they finished. When the log is
+// still the file `from` was taken of and has grown past it, only the part
+// after it is read. That limits the result to the build since then, even if
+// it was too short to tell apart by its times. Otherwise the whole log is
+// read and only the times separate the runs. Empty if the log is missing.
+QVector<Entry> lastRun(const QString &path, const Position &from = Position());
+
+struct Concurrency {
+  int steps = 0;
+  // First start to last end
+  qint64 wallMs = 0;
+  // Sum of all step durations
+  qint64 busyMs = 0;
+  // Most steps running at the same time
+  int peak = 0;
+
+  double average() const { return wallMs > 0 ? double(busyMs) / wallMs : 0.0; }
+};
+
+Concurrency concurrency(const QVector<Entry> &entries);
+
+} // namespace NinjaLog
@@ -0,0 +1,921 @@
+#include "pixelkernels.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) ||           \
+    defined(_M_IX86)
+#define PK_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define PK_TARGET_SSE2
+#define PK_TARGET_AVX2
+#else
+#define PK_TARGET_SSE2 __attribute__((target("sse2")))
+#define PK_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define PK_NEON 1
+#include <arm_neon.h>
+#endif
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+typedef void (*ConvertFn)(const uint8_t *src, uint8_t *dst, int pixels);
+typedef void (*DitherFn)(const uint8_t *src, uint8_t *dst, int pixels,
+                         int row);
+typedef void (*HorizontalFn)(const uint8_t *src, uint8_t *dst, int dstWidth,
+                             const int *starts, int taps,
+                             const int16_t *weights);
+typedef void (*VerticalFn)(const uint8_t *src, int srcStride, int taps,
+                           const int16_t *weights, uint8_t *dst, int bytes);
+
+// Resampling weights are fixed point with this many fractional bits; every
+// path rounds and clamps the integer sums the same way.
+const int kWeightBits = PixelKernels::kResampleWeightBits;
+const int kWeightRound = 1 << (kWeightBits - 1);
+
+inline uint8_t clampByte(int v) {
+  return static_cast<uint8_t>(std::min(255, std::max(0, v)));
+}
+
+// Per-row ordered dither offsets for four consecutive pixels, laid out as
+// r, g, b, 0 per pixel so one 16-byte vector covers a full period of the
+// 4x4 Bayer matrix. Each offset is (2 * M + 1) * step / 32, i.e. the Bayer
+// threshold scaled to the channel's quantization step (8 for the 5-bit red
+// and blue channels, 4 for the 6-bit green one).
+alignas(16) const uint8_t kOrderedBias[4][16] = {
+    {0, 0, 0, 0, 4, 2, 4, 0, 1, 0, 1, 0, 5, 2, 5, 0},
+    {6, 3, 6, 0, 2, 1, 2, 0, 7, 3, 7, 0, 3, 1, 3, 0},
+    {1, 0, 1, 0, 5, 2, 5, 0, 0, 0, 0, 0, 4, 2, 4, 0},
+    {7, 3, 7, 0, 3, 1, 3, 0, 6, 3, 6, 0, 2, 1, 2, 0},
+};
+
+// LVGL expands 565 back to 8 bits by bit replication, so level n shows as
+// roughly n * 255 / 31 rather than n * 8. Left alone, dithering would average
+// out to a ~3% brighter image; scaling the input by 31/32 (63/64 for green)
+// first cancels that. It also keeps value + offset within 255.
+inline uint8_t ditherChannel(uint8_t v, int shift, uint8_t bias) {
+  return static_cast<uint8_t>(v - (v >> shift) + bias);
+}
+
+inline uint16_t pack565(uint8_t r, uint8_t g, uint8_t b) {
+  return static_cast<uint16_t>(((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3));
+}
+
+inline void store565(uint8_t *dst, uint16_t c) {
+  dst[0] = static_cast<uint8_t>(c & 0xff);
+  dst[1] = static_cast<uint8_t>(c >> 8);
+}
+
+// ---------------------------------------------------------------------------
+// Scalar reference
+// ---------------------------------------------------------------------------
+
+void rgba8888ToRgb565Scalar(const uint8_t *src, uint8_t *dst, int pixels) {
+  for (int i = 0; i < pixels; ++i) {
+    store565(dst + 2 * i, pack565(src[4 * i], src[4 * i + 1], src[4 * i + 2]));
+  }
+}
+
+void rgb888ToRgb565Scalar(const uint8_t *src, uint8_t *dst, int pixels) {
+  for (int i = 0; i < pixels; ++i) {
+    store565(dst + 2 * i, pack565(src[3 * i], src[3 * i + 1], src[3 * i + 2]));
+  }
+}
+
+// Vector loops hand over to these at multiples of four pixels, so the
+// position within the row's bias period is just `i & 3`.
+void rgba8888ToRgb565OrderedScalar(const uint8_t *src, uint8_t *dst,
+                                   int pixels, int row) {
+  const uint8_t *bias = kOrderedBias[row & 3];
+  for (int i = 0; i < pixels; ++i) {
+    const uint8_t *p = src + 4 * i;
+    const uint8_t *b = bias + 4 * (i & 3);
+    store565(dst + 2 * i,
+             pack565(ditherChannel(p[0], 5, b[0]), ditherChannel(p[1], 6, b[1]),
+                     ditherChannel(p[2], 5, b[2])));
+  }
+}
+
+void rgb888ToRgb565OrderedScalar(const uint8_t *src, uint8_t *dst, int pixels,
+                                 int row) {
+  const uint8_t *bias = kOrderedBias[row & 3];
+  for (int i = 0; i < pixels; ++i) {
+    const uint8_t *p = src + 3 * i;
+    const uint8_t *b = bias + 4 * (i & 3);
+    store565(dst + 2 * i,
+             pack565(ditherChannel(p[0], 5, b[0]), ditherChannel(p[1], 6, b[1]),
+                     ditherChannel(p[2], 5, b[2])));
+  }
+}
+
+// `src` and `dst` may be the same buffer
+void swapRgb565Scalar(const uint8_t *src, uint8_t *dst, int pixels) {
+  for (int i = 0; i < pixels; ++i) {
+    const uint8_t lo = src[2 * i];
+    dst[2 * i] = src[2 * i + 1];
+    dst[2 * i + 1] = lo;
+  }
+}
+
+void resampleHorizontalScalar(const uint8_t *src, uint8_t *dst, int dstWidth,
+                              const int *starts, int taps,
+                              const int16_t *weights) {
+  for (int x = 0; x < dstWidth; ++x) {
+    const uint8_t *p = src + 4 * starts[x];
+    const int16_t *w = weights + x * taps;
+    int acc[4] = {kWeightRound, kWeightRound, kWeightRound, kWeightRound};
+    for (int k = 0; k < taps; ++k) {
+      for (int c = 0; c < 4; ++c) {
+        acc[c] += p[4 * k + c] * w[k];
+      }
+    }
+    for (int c = 0; c < 4; ++c) {
+      dst[4 * x + c] = clampByte(acc[c] >> kWeightBits);
+    }
+  }
+}
+
+void resampleVerticalScalar(const uint8_t *src, int srcStride, int taps,
+                            const int16_t *weights, uint8_t *dst, int bytes) {
+  for (int i = 0; i < bytes; ++i) {
+    int acc = kWeightRound;
+    for (int k = 0; k < taps; ++k) {
+      acc += src[k * srcStride + i] * weights[k];
+    }
+    dst[i] = clampByte(acc >> kWeightBits);
+  }
+}
+
+#ifdef PK_X86
+// ---------------------------------------------------------------------------
+// SSE2
+// ---------------------------------------------------------------------------
+
+// Each 32-bit lane holds one pixel as r | g << 8 | b << 16 (the top byte is
+// ignored). Returns the RGB565 value sign-extended to 32 bits so that
+// _mm_packs_epi32 keeps all 16 bits instead of saturating.
+PK_TARGET_SSE2 inline __m128i pack565Sse2(__m128i px) {
+  const __m128i r =
+      _mm_and_si128(_mm_slli_epi32(px, 8), _mm_set1_epi32(0xf800));
+  const __m128i g =
+      _mm_and_si128(_mm_srli_epi32(px, 5), _mm_set1_epi32(0x07e0));
+  const __m128i b =
+      _mm_and_si128(_mm_srli_epi32(px, 19), _mm_set1_epi32(0x001f));
+  const __m128i c = _mm_or_si128(_mm_or_si128(r, g), b);
+  return _mm_srai_epi32(_mm_slli_epi32(c, 16), 16);
+}
+
+// Spreads four packed RGB888 pixels (12 bytes) into one 32-bit lane each.
+// Reads 16 bytes from `p`.
+PK_TARGET_SSE2 inline __m128i loadRgb888Sse2(const uint8_t *p) {
+  const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+  __m128i x = _mm_and_si128(v, _mm_setr_epi32(-1, 0, 0, 0));
+  x = _mm_or_si128(
+      x, _mm_and_si128(_mm_slli_si128(v, 1), _mm_setr_epi32(0, -1, 0, 0)));
+  x = _mm_or_si128(
+      x, _mm_and_si128(_mm_slli_si128(v, 2), _mm_setr_epi32(0, 0, -1, 0)));
+  x = _mm_or_si128(
+      x, _mm_and_si128(_mm_slli_si128(v, 3), _mm_setr_epi32(0, 0, 0, -1)));
+  return x;
+}
+
+PK_TARGET_SSE2 void rgba8888ToRgb565Sse2(const uint8_t *src, uint8_t *dst,
+                                         int pixels) {
+  int i = 0;
+  for (; i + 8 <= pixels; i += 8) {
+    const __m128i a =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 4 * i));
+    const __m128i b =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 4 * i + 16));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + 2 * i),
+                     _mm_packs_epi32(pack565Sse2(a), pack565Sse2(b)));
+  }
+  rgba8888ToRgb565Scalar(src + 4 * i, dst + 2 * i, pixels - i);
+}
+
+PK_TARGET_SSE2 void rgb888ToRgb565Sse2(const uint8_t *src, uint8_t *dst,
+                                       int pixels) {
+  int i = 0;
+  // The second 16-byte load starts 12 bytes in, so keep 28 bytes in range.
+  for (; i + 10 <= pixels; i += 8) {
+    const __m128i a = loadRgb888Sse2(src + 3 * i);
+    const __m128i b = loadRgb888Sse2(src + 3 * i + 12);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + 2 * i),
+                     _mm_packs_epi32(pack565Sse2(a), pack565Sse2(b)));
+  }
+  rgb888ToRgb565Scalar(src + 3 * i, dst + 2 * i, pixels - i);
+}
+
+PK_TARGET_SSE2 inline __m128i orderedBiasSse2(int row) {
+  return _mm_load_si128(reinterpret_cast<const __m128i *>(kOrderedBias[row & 3]));
+}
+
+// Vector form of ditherChannel() on r, g, b, x lanes. The 16-bit shifts pull
+// bits across byte boundaries, but the masks keep only each byte's own bits.
+PK_TARGET_SSE2 inline __m128i ditherSse2(__m128i px, __m128i bias) {
+  const __m128i rb = _mm_and_si128(_mm_srli_epi16(px, 5),
+                                   _mm_set1_epi32(0x00070007));
+  const __m128i g = _mm_and_si128(_mm_srli_epi16(px, 6),
+                                  _mm_set1_epi32(0x00000300));
+  return _mm_add_epi8(_mm_sub_epi8(px, _mm_or_si128(rb, g)), bias);
+}
+
+PK_TARGET_SSE2 void rgba8888ToRgb565OrderedSse2(const uint8_t *src,
+                                                uint8_t *dst, int pixels,
+                                                int row) {
+  const __m128i bias = orderedBiasSse2(row);
+  int i = 0;
+  for (; i + 8 <= pixels; i += 8) {
+    const __m128i a = ditherSse2(
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 4 * i)), bias);
+    const __m128i b = ditherSse2(
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 4 * i + 16)),
+        bias);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + 2 * i),
+                     _mm_packs_epi32(pack565Sse2(a), pack565Sse2(b)));
+  }
+  rgba8888ToRgb565OrderedScalar(src + 4 * i, dst + 2 * i, pixels - i, row);
+}
+
+PK_TARGET_SSE2 void rgb888ToRgb565OrderedSse2(const uint8_t *src, uint8_t *dst,
+                                              int pixels, int row) {
+  const __m128i bias = orderedBiasSse2(row);
+  int i = 0;
+  for (; i + 10 <= pixels; i += 8) {
+    const __m128i a = ditherSse2(loadRgb888Sse2(src + 3 * i), bias);
+    const __m128i b = ditherSse2(loadRgb888Sse2(src + 3 * i + 12), bias);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + 2 * i),
+                     _mm_packs_epi32(pack565Sse2(a), pack565Sse2(b)));
+  }
+  rgb888ToRgb565OrderedScalar(src + 3 * i, dst + 2 * i, pixels - i, row);
+}
+
+PK_TARGET_SSE2 void swapRgb565Sse2(const uint8_t *src, uint8_t *dst,
+                                   int pixels) {
+  int i = 0;
+  for (; i + 8 <= pixels; i += 8) {
+    const __m128i v =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 2 * i));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + 2 * i),
+                     _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8)));
+  }
+  swapRgb565Scalar(src + 2 * i, dst + 2 * i, pixels - i);
+}
+
+// Two weights side by side in each 32-bit lane, for _mm_madd_epi16 over
+// interleaved pairs of samples.
+inline int32_t weightPair(int16_t a, int16_t b) {
+  return int32_t(uint32_t(uint16_t(a)) | uint32_t(uint16_t(b)) << 16);
+}
+
+// One output pixel per iteration, two taps per madd: the channels of
+// neighbouring source pixels are interleaved as r0 r1 g0 g1 b0 b1 a0 a1.
+PK_TARGET_SSE2 void resampleHorizontalSse2(const uint8_t *src, uint8_t *dst,
+                                           int dstWidth, const int *starts,
+                                           int taps, const int16_t *weights) {
+  const __m128i zero = _mm_setzero_si128();
+  for (int x = 0; x < dstWidth; ++x) {
+    const uint8_t *p = src + 4 * starts[x];
+    const int16_t *w = weights + x * taps;
+    __m128i acc = _mm_set1_epi32(kWeightRound);
+    int k = 0;
+    for (; k + 2 <= taps; k += 2) {
+      const __m128i px = _mm_unpacklo_epi8(
+          _mm_loadl_epi64(reinterpret_cast<const __m128i *>(p + 4 * k)), zero);
+      const __m128i pairs = _mm_unpacklo_epi16(px, _mm_srli_si128(px, 8));
+      acc = _mm_add_epi32(
+          acc, _mm_madd_epi16(pairs, _mm_set1_epi32(weightPair(w[k], w[k + 1]))));
+    }
+    if (k < taps) {
+      int32_t last;
+      std::memcpy(&last, p + 4 * k, 4);
+      const __m128i px = _mm_unpacklo_epi16(
+          _mm_unpacklo_epi8(_mm_cvtsi32_si128(last), zero), zero);
+      acc = _mm_add_epi32(
+          acc, _mm_madd_epi16(px, _mm_set1_epi32(weightPair(w[k], 0))));
+    }
+    const __m128i words = _mm_packs_epi32(_mm_srai_epi32(acc, kWeightBits), zero);
+    const int32_t out = _mm_cvtsi128_si32(_mm_packus_epi16(words, zero));
+    std::memcpy(dst + 4 * x, &out, 4);
+  }
+}
+
+// 16 bytes of one output row per iteration, two source rows per madd.
+PK_TARGET_SSE2 void resampleVerticalSse2(const uint8_t *src, int srcStride,
+                                         int taps, const int16_t *weights,
+                                         uint8_t *dst, int bytes) {
+  const __m128i zero = _mm_setzero_si128();
+  int i = 0;
+  for (; i + 16 <= bytes; i += 16) {
+    __m128i acc0 = _mm_set1_epi32(kWeightRound);
+    __m128i acc1 = acc0, acc2 = acc0, acc3 = acc0;
+    int k = 0;
+    for (; k + 2 <= taps; k += 2) {
+      const __m128i a = _mm_loadu_si128(
+          reinterpret_cast<const __m128i *>(src + k * srcStride + i));
+      const __m128i b = _mm_loadu_si128(
+          reinterpret_cast<const __m128i *>(src + (k + 1) * srcStride + i));
+      const __m128i w = _mm_set1_epi32(weightPair(weights[k], weights[k + 1]));
+      const __m128i lo = _mm_unpacklo_epi8(a, b);
+      const __m128i hi = _mm_unpackhi_epi8(a, b);
+      acc0 = _mm_add_epi32(acc0, _mm_madd_epi16(_mm_unpacklo_epi8(lo, zero), w));
+      acc1 = _mm_add_epi32(acc1, _mm_madd_epi16(_mm_unpackhi_epi8(lo, zero), w));
+      acc2 = _mm_add_epi32(acc2, _mm_madd_epi16(_mm_unpacklo_epi8(hi, zero), w));
+      acc3 = _mm_add_epi32(acc3, _mm_madd_epi16(_mm_unpackhi_epi8(hi, zero), w));
+    }
+    if (k < taps) {
+      const __m128i a = _mm_loadu_si128(
+          reinterpret_cast<const __m128i *>(src + k * srcStride + i));
+      const __m128i w = _mm_set1_epi32(weightPair(weights[k], 0));
+      const __m128i lo = _mm_unpacklo_epi8(a, zero);
+      const __m128i hi = _mm_unpackhi_epi8(a, zero);
+      acc0 = _mm_add_epi32(acc0, _mm_madd_epi16(_mm_unpacklo_epi16(lo, zero), w));
+      acc1 = _mm_add_epi32(acc1, _mm_madd_epi16(_mm_unpackhi_epi16(lo, zero), w));
+      acc2 = _mm_add_epi32(acc2, _mm_madd_epi16(_mm_unpacklo_epi16(hi, zero), w));
+      acc3 = _mm_add_epi32(acc3, _mm_madd_epi16(_mm_unpackhi_epi16(hi, zero), w));
+    }
+    const __m128i lo =
+        _mm_packs_epi32(_mm_srai_epi32(acc0, kWeightBits),
+                        _mm_srai_epi32(acc1, kWeightBits));
+    const __m128i hi =
+        _mm_packs_epi32(_mm_srai_epi32(acc2, kWeightBits),
+                        _mm_srai_epi32(acc3, kWeightBits));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i),
+                     _mm_packus_epi16(lo, hi));
+  }
+  resampleVerticalScalar(src + i, srcStride, taps, weights, dst + i, bytes - i);
+}
+
+// ---------------------------------------------------------------------------
+// AVX2
+// ---------------------------------------------------------------------------
+
+PK_TARGET_AVX2 inline __m256i pack565Avx2(__m256i px) {
+  const __m256i r =
+      _mm256_and_si256(_mm256_slli_epi32(px, 8), _mm256_set1_epi32(0xf800));
+  const __m256i g =
+      _mm256_and_si256(_mm256_srli_epi32(px, 5), _mm256_set1_epi32(0x07e0));
+  const __m256i b =
+      _mm256_and_si256(_mm256_srli_epi32(px, 19), _mm256_set1_epi32(0x001f));
+  const __m256i c = _mm256_or_si256(_mm256_or_si256(r, g), b);
+  return _mm256_srai_epi32(_mm256_slli_epi32(c, 16), 16);
+}
+
+// packs_epi32 works per 128-bit half; restore pixel order afterwards.
+PK_TARGET_AVX2 inline __m256i packPixelsAvx2(__m256i a, __m256i b) {
+  return _mm256_permute4x64_epi64(
+      _mm256_packs_epi32(pack565Avx2(a), pack565Avx2(b)), 0xd8);
+}
+
+// Eight RGB888 pixels (24 bytes) into 32-bit lanes. Reads 28 bytes.
+PK_TARGET_AVX2 inline __m256i loadRgb888Avx2(const uint8_t *p) {
+  const __m256i shuffle = _mm256_setr_epi8(
+      0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1, //
+      0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+  const __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+  const __m128i hi =
+      _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 12));
+  const __m256i v = _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+  return _mm256_shuffle_epi8(v, shuffle);
+}
+
+PK_TARGET_AVX2 void rgba8888ToRgb565Avx2(const uint8_t *src, uint8_t *dst,
+                                         int pixels) {
+  int i = 0;
+  for (; i + 16 <= pixels; i += 16) {
+    const __m256i a =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + 4 * i));
+    const __m256i b = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i *>(src + 4 * i + 32));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + 2 * i),
+                        packPixelsAvx2(a, b));
+  }
+  rgba8888ToRgb565Sse2(src + 4 * i, dst + 2 * i, pixels - i);
+}
+
+PK_TARGET_AVX2 void rgb888ToRgb565Avx2(const uint8_t *src, uint8_t *dst,
+                                       int pixels) {
+  int i = 0;
+  // The last 16-byte load starts 36 bytes in, so keep 52 bytes in range.
+  for (; i + 18 <= pixels; i += 16) {
+    const __m256i a = loadRgb888Avx2(src + 3 * i);
+    const __m256i b = loadRgb888Avx2(src + 3 * i + 24);
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + 2 * i),
+                        packPixelsAvx2(a, b));
+  }
+  rgb888ToRgb565Sse2(src + 3 * i, dst + 2 * i, pixels - i);
+}
+
+// Eight pixels per 256-bit vector is two bias periods.
+PK_TARGET_AVX2 inline __m256i orderedBiasAvx2(int row) {
+  return _mm256_broadcastsi128_si256(
+      _mm_load_si128(reinterpret_cast<const __m128i *>(kOrderedBias[row & 3])));
+}
+
+PK_TARGET_AVX2 inline __m256i ditherAvx2(__m256i px, __m256i bias) {
+  const __m256i rb = _mm256_and_si256(_mm256_srli_epi16(px, 5),
+                                      _mm256_set1_epi32(0x00070007));
+  const __m256i g = _mm256_and_si256(_mm256_srli_epi16(px, 6),
+                                     _mm256_set1_epi32(0x00000300));
+  return _mm256_add_epi8(_mm256_sub_epi8(px, _mm256_or_si256(rb, g)), bias);
+}
+
+PK_TARGET_AVX2 void rgba8888ToRgb565OrderedAvx2(const uint8_t *src,
+                                                uint8_t *dst, int pixels,
+                                                int row) {
+  const __m256i bias = orderedBiasAvx2(row);
+  int i = 0;
+  for (; i + 16 <= pixels; i += 16) {
+    const __m256i a = ditherAvx2(
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + 4 * i)),
+        bias);
+    const __m256i b = ditherAvx2(
+        _mm256_loadu_si256(
+            reinterpret_cast<const __m256i *>(src + 4 * i + 32)),
+        bias);
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + 2 * i),
+                        packPixelsAvx2(a, b));
+  }
+  rgba8888ToRgb565OrderedSse2(src + 4 * i, dst + 2 * i, pixels - i, row);
+}
+
+PK_TARGET_AVX2 void rgb888ToRgb565OrderedAvx2(const uint8_t *src, uint8_t *dst,
+                                              int pixels, int row) {
+  const __m256i bias = orderedBiasAvx2(row);
+  int i = 0;
+  for (; i + 18 <= pixels; i += 16) {
+    const __m256i a = ditherAvx2(loadRgb888Avx2(src + 3 * i), bias);
+    const __m256i b = ditherAvx2(loadRgb888Avx2(src + 3 * i + 24), bias);
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + 2 * i),
+                        packPixelsAvx2(a, b));
+  }
+  rgb888ToRgb565OrderedSse2(src + 3 * i, dst + 2 * i, pixels - i, row);
+}
+
+// Same as the SSE2 version on 32 bytes. Unpacking and packing both work
+// within 128-bit lanes, so the output comes back in order without a permute.
+PK_TARGET_AVX2 void resampleVerticalAvx2(const uint8_t *src, int srcStride,
+                                         int taps, const int16_t *weights,
+                                         uint8_t *dst, int bytes) {
+  const __m256i zero = _mm256_setzero_si256();
+  int i = 0;
+  for (; i + 32 <= bytes; i += 32) {
+    __m256i acc0 = _mm256_set1_epi32(kWeightRound);
+    __m256i acc1 = acc0, acc2 = acc0, acc3 = acc0;
+    int k = 0;
+    for (; k + 2 <= taps; k += 2) {
+      const __m256i a = _mm256_loadu_si256(
+          reinterpret_cast<const __m256i *>(src + k * srcStride + i));
+      const __m256i b = _mm256_loadu_si256(
+          reinterpret_cast<const __m256i *>(src + (k + 1) * srcStride + i));
+      const __m256i w =
+          _mm256_set1_epi32(weightPair(weights[k], weights[k + 1]));
+      const __m256i lo = _mm256_unpacklo_epi8(a, b);
+      const __m256i hi = _mm256_unpackhi_epi8(a, b);
+      acc0 = _mm256_add_epi32(
+          acc0, _mm256_madd_epi16(_mm256_unpacklo_epi8(lo, zero), w));
+      acc1 = _mm256_add_epi32(
+          acc1, _mm256_madd_epi16(_mm256_unpackhi_epi8(lo, zero), w));
+      acc2 = _mm256_add_epi32(
+          acc2, _mm256_madd_epi16(_mm256_unpacklo_epi8(hi, zero), w));
+      acc3 = _mm256_add_epi32(
+          acc3, _mm256_madd_epi16(_mm256_unpackhi_epi8(hi, zero), w));
+    }
+    if (k < taps) {
+      const __m256i a = _mm256_loadu_si256(
+          reinterpret_cast<const __m256i *>(src + k * srcStride + i));
+      const __m256i w = _mm256_set1_epi32(weightPair(weights[k], 0));
+      const __m256i lo = _mm256_unpacklo_epi8(a, zero);
+      const __m256i hi = _mm256_unpackhi_epi8(a, zero);
+      acc0 = _mm256_add_epi32(
+          acc0, _mm256_madd_epi16(_mm256_unpacklo_epi16(lo, zero), w));
+      acc1 = _mm256_add_epi32(
+          acc1, _mm256_madd_epi16(_mm256_unpackhi_epi16(lo, zero), w));
+      acc2 = _mm256_add_epi32(
+          acc2, _mm256_madd_epi16(_mm256_unpacklo_epi16(hi, zero), w));
+      acc3 = _mm256_add_epi32(
+          acc3, _mm256_madd_epi16(_mm256_unpackhi_epi16(hi, zero), w));
+    }
+    const __m256i lo =
+        _mm256_packs_epi32(_mm256_srai_epi32(acc0, kWeightBits),
+                           _mm256_srai_epi32(acc1, kWeightBits));
+    const __m256i hi =
+        _mm256_packs_epi32(_mm256_srai_epi32(acc2, kWeightBits),
+                           _mm256_srai_epi32(acc3, kWeightBits));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i),
+                        _mm256_packus_epi16(lo, hi));
+  }
+  resampleVerticalSse2(src + i, srcStride, taps, weights, dst + i, bytes - i);
+}
+
+PK_TARGET_AVX2 void swapRgb565Avx2(const uint8_t *src, uint8_t *dst,
+                                   int pixels) {
+  int i = 0;
+  for (; i + 16 <= pixels; i += 16) {
+    const __m256i v =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + 2 * i));
+    _mm256_storeu_si256(
+        reinterpret_cast<__m256i *>(dst + 2 * i),
+        _mm256_or_si256(_mm256_slli_epi16(v, 8), _mm256_srli_epi16(v, 8)));
+  }
+  swapRgb565Sse2(src + 2 * i, dst + 2 * i, pixels - i);
+}
+
+bool cpuHasSse2() {
+#if defined(__x86_64__) || defined(_M_X64)
+  return true;
+#elif defined(_MSC_VER) && !defined(__clang__)
+  int info[4];
+  __cpuid(info, 1);
+  return (info[3] & (1 << 26)) != 0;
+#else
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("sse2");
+#endif
+}
+
+bool cpuHasAvx2() {
+#if defined(_MSC_VER) && !defined(__clang__)
+  int info[4];
+  __cpuid(info, 0);
+  if (info[0] < 7) {
+    return false;
+  }
+  __cpuid(info, 1);
+  const bool osxsave = (info[2] & (1 << 27)) != 0;
+  const bool avx = (info[2] & (1 << 28)) != 0;
+  // The OS must also save the YMM registers on context switch.
+  if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6) {
+    return false;
+  }
+  __cpuidex(info, 7, 0);
+  return (info[1] & (1 << 5)) != 0;
+#else
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif // PK_X86
+
+#ifdef PK_NEON
+// ---------------------------------------------------------------------------
+// NEON
+// ---------------------------------------------------------------------------
+
+inline uint16x8_t pack565Neon(uint8x8_t r, uint8x8_t g, uint8x8_t b) {
+  uint16x8_t c = vshll_n_u8(r, 8);
+  c = vsriq_n_u16(c, vshll_n_u8(g, 8), 5);
+  c = vsriq_n_u16(c, vshll_n_u8(b, 8), 11);
+  return c;
+}
+
+inline void store565Neon(uint8_t *dst, uint8x16_t r, uint8x16_t g,
+                         uint8x16_t b) {
+  const uint16x8_t lo =
+      pack565Neon(vget_low_u8(r), vget_low_u8(g), vget_low_u8(b));
+  const uint16x8_t hi =
+      pack565Neon(vget_high_u8(r), vget_high_u8(g), vget_high_u8(b));
+  vst1q_u8(dst, vreinterpretq_u8_u16(lo));
+  vst1q_u8(dst + 16, vreinterpretq_u8_u16(hi));
+}
+
+void rgba8888ToRgb565Neon(const uint8_t *src, uint8_t *dst, int pixels) {
+  int i = 0;
+  for (; i + 16 <= pixels; i += 16) {
+    const uint8x16x4_t px = vld4q_u8(src + 4 * i);
+    store565Neon(dst + 2 * i, px.val[0], px.val[1], px.val[2]);
+  }
+  rgba8888ToRgb565Scalar(src + 4 * i, dst + 2 * i, pixels - i);
+}
+
+void rgb888ToRgb565Neon(const uint8_t *src, uint8_t *dst, int pixels) {
+  int i = 0;
+  for (; i + 16 <= pixels; i += 16) {
+    const uint8x16x3_t px = vld3q_u8(src + 3 * i);
+    store565Neon(dst + 2 * i, px.val[0], px.val[1], px.val[2]);
+  }
+  rgb888ToRgb565Scalar(src + 3 * i, dst + 2 * i, pixels - i);
+}
+// vld4 of the bias row repeated four times yields one 16-pixel offset
+// vector per channel.
+inline uint8x16x4_t orderedBiasNeon(int row) {
+  uint8_t pattern[64];
+  for (int k = 0; k < 4; ++k) {
+    std::memcpy(pattern + 16 * k, kOrderedBias[row & 3], 16);
+  }
+  return vld4q_u8(pattern);
+}
+
+inline uint8x16_t ditherNeon(uint8x16_t v, int shift, uint8x16_t bias) {
+  const uint8x16_t reduced =
+      shift == 5 ? vshrq_n_u8(v, 5) : vshrq_n_u8(v, 6);
+  return vaddq_u8(vsubq_u8(v, reduced), bias);
+}
+
+void rgba8888ToRgb565OrderedNeon(const uint8_t *src, uint8_t *dst, int pixels,
+                                 int row) {
+  const uint8x16x4_t bias = orderedBiasNeon(row);
+  int i = 0;
+  for (; i + 16 <= pixels; i += 16) {
+    const uint8x16x4_t px = vld4q_u8(src + 4 * i);
+    store565Neon(dst + 2 * i, ditherNeon(px.val[0], 5, bias.val[0]),
+                 ditherNeon(px.val[1], 6, bias.val[1]),
+                 ditherNeon(px.val[2], 5, bias.val[2]));
+  }
+  rgba8888ToRgb565OrderedScalar(src + 4 * i, dst + 2 * i, pixels - i, row);
+}
+
+void rgb888ToRgb565OrderedNeon(const uint8_t *src, uint8_t *dst, int pixels,
+                               int row) {
+  const uint8x16x4_t bias = orderedBiasNeon(row);
+  int i = 0;
+  for (; i + 16 <= pixels; i += 16) {
+    const uint8x16x3_t px = vld3q_u8(src + 3 * i);
+    store565Neon(dst + 2 * i, ditherNeon(px.val[0], 5, bias.val[0]),
+                 ditherNeon(px.val[1], 6, bias.val[1]),
+                 ditherNeon(px.val[2], 5, bias.val[2]));
+  }
+  rgb888ToRgb565OrderedScalar(src + 3 * i, dst + 2 * i, pixels - i, row);
+}
+
+void resampleHorizontalNeon(const uint8_t *src, uint8_t *dst, int dstWidth,
+                            const int *starts, int taps,
+                            const int16_t *weights) {
+  for (int x = 0; x < dstWidth; ++x) {
+    const uint8_t *p = src + 4 * starts[x];
+    const int16_t *w = weights + x * taps;
+    int32x4_t acc = vdupq_n_s32(kWeightRound);
+    for (int k = 0; k < taps; ++k) {
+      uint32_t word;
+      std::memcpy(&word, p + 4 * k, 4);
+      const int16x4_t px = vget_low_s16(
+          vreinterpretq_s16_u16(vmovl_u8(vreinterpret_u8_u32(vdup_n_u32(word)))));
+      acc = vmlal_n_s16(acc, px, w[k]);
+    }
+    const int16x4_t words = vqmovn_s32(vshrq_n_s32(acc, kWeightBits));
+    const uint8x8_t bytes = vqmovun_s16(vcombine_s16(words, words));
+    const uint32_t out = vget_lane_u32(vreinterpret_u32_u8(bytes), 0);
+    std::memcpy(dst + 4 * x, &out, 4);
+  }
+}
+
+void resampleVerticalNeon(const uint8_t *src, int srcStride, int taps,
+                          const int16_t *weights, uint8_t *dst, int bytes) {
+  int i = 0;
+  for (; i + 16 <= bytes; i += 16) {
+    int32x4_t acc0 = vdupq_n_s32(kWeightRound);
+    int32x4_t acc1 = acc0, acc2 = acc0, acc3 = acc0;
+    for (int k = 0; k < taps; ++k) {
+      const uint8x16_t v = vld1q_u8(src + k * srcStride + i);
+      const int16x8_t lo = vreinterpretq_s16_u16(vmovl_u8(vget_low_u8(v)));
+      const int16x8_t hi = vreinterpretq_s16_u16(vmovl_u8(vget_high_u8(v)));
+      acc0 = vmlal_n_s16(acc0, vget_low_s16(lo), weights[k]);
+      acc1 = vmlal_n_s16(acc1, vget_high_s16(lo), weights[k]);
+      acc2 = vmlal_n_s16(acc2, vget_low_s16(hi), weights[k]);
+      acc3 = vmlal_n_s16(acc3, vget_high_s16(hi), weights[k]);
+    }
+    const int16x8_t lo = vcombine_s16(vqmovn_s32(vshrq_n_s32(acc0, kWeightBits)),
+                                      vqmovn_s32(vshrq_n_s32(acc1, kWeightBits)));
+    const int16x8_t hi = vcombine_s16(vqmovn_s32(vshrq_n_s32(acc2, kWeightBits)),
+                                      vqmovn_s32(vshrq_n_s32(acc3, kWeightBits)));
+    vst1q_u8(dst + i, vcombine_u8(vqmovun_s16(lo), vqmovun_s16(hi)));
+  }
+  resampleVerticalScalar(src + i, srcStride, taps, weights, dst + i, bytes - i);
+}
+
+void swapRgb565Neon(const uint8_t *src, uint8_t *dst, int pixels) {
+  int i = 0;
+  for (; i + 8 <= pixels; i += 8) {
+    vst1q_u8(dst + 2 * i, vrev16q_u8(vld1q_u8(src + 2 * i)));
+  }
+  swapRgb565Scalar(src + 2 * i, dst + 2 * i, pixels - i);
+}
+#endif // PK_NEON
+
+struct KernelTable {
+  ConvertFn rgba8888ToRgb565;
+  ConvertFn rgb888ToRgb565;
+  DitherFn rgba8888ToRgb565Ordered;
+  DitherFn rgb888ToRgb565Ordered;
+  ConvertFn swapRgb565;
+  HorizontalFn resampleHorizontal;
+  VerticalFn resampleVertical;
+};
+
+KernelTable kernelsFor(PixelKernels::Isa isa) {
+  switch (isa) {
+#ifdef PK_X86
+  case PixelKernels::Isa::SSE2:
+    return {rgba8888ToRgb565Sse2, rgb888ToRgb565Sse2,
+            rgba8888ToRgb565OrderedSse2, rgb888ToRgb565OrderedSse2,
+            swapRgb565Sse2, resampleHorizontalSse2, resampleVerticalSse2};
+  case PixelKernels::Isa::AVX2:
+    return {rgba8888ToRgb565Avx2, rgb888ToRgb565Avx2,
+            rgba8888ToRgb565OrderedAvx2, rgb888ToRgb565OrderedAvx2,
+            swapRgb565Avx2, resampleHorizontalSse2, resampleVerticalAvx2};
+#endif
+#ifdef PK_NEON
+  case PixelKernels::Isa::NEON:
+    return {rgba8888ToRgb565Neon, rgb888ToRgb565Neon,
+            rgba8888ToRgb565OrderedNeon, rgb888ToRgb565OrderedNeon,
+            swapRgb565Neon, resampleHorizontalNeon, resampleVerticalNeon};
+#endif
+  default:
+    return {rgba8888ToRgb565Scalar, rgb888ToRgb565Scalar,
+            rgba8888ToRgb565OrderedScalar, rgb888ToRgb565OrderedScalar,
+            swapRgb565Scalar, resampleHorizontalScalar,
+            resampleVerticalScalar};
+  }
+}
+
+PixelKernels::Isa detectIsa() {
+  const PixelKernels::Isa preferred[] = {PixelKernels::Isa::AVX2,
+                                         PixelKernels::Isa::NEON,
+                                         PixelKernels::Isa::SSE2};
+  for (PixelKernels::Isa isa : preferred) {
+    if (PixelKernels::isIsaSupported(isa)) {
+      return isa;
+    }
+  }
+  return PixelKernels::Isa::Scalar;
+}
+
+// Rounds an 8-bit value to the nearest level of a `bits`-wide channel and
+// returns that level; `reconstructed` is the 8-bit value the panel shows for
+// it (LVGL expands 565 by bit replication).
+inline int quantizeChannel(int v, int bits, int &reconstructed) {
+  const int max = (1 << bits) - 1;
+  const int level = (v * max + 127) / 255;
+  reconstructed = (level << (8 - bits)) | (level >> (2 * bits - 8));
+  return level;
+}
+
+const KernelTable &activeKernels() {
+  static const KernelTable table = kernelsFor(PixelKernels::activeIsa());
+  return table;
+}
+
+} // namespace
+
+namespace PixelKernels {
+
+const char *isaName(Isa isa) {
+  switch (isa) {
+  case Isa::Scalar:
+    return "scalar";
+  case Isa::SSE2:
+    return "SSE2";
+  case Isa::AVX2:
+    return "AVX2";
+  case Isa::NEON:
+    return "NEON";
+  }
+  return "unknown";
+}
+
+bool isIsaSupported(Isa isa) {
+  switch (isa) {
+  case Isa::Scalar:
+    return true;
+#ifdef PK_X86
+  case Isa::SSE2:
+    return cpuHasSse2();
+  case Isa::AVX2:
+    return cpuHasSse2() && cpuHasAvx2();
+#endif
+#ifdef PK_NEON
+  case Isa::NEON:
+    return true;
+#endif
+  default:
+    return false;
+  }
+}
+
+Isa activeIsa() {
+  static const Isa isa = detectIsa();
+  return isa;
+}
+
+void rgba8888ToRgb565(const uint8_t *src, uint8_t *dst, int pixels) {
+  activeKernels().rgba8888ToRgb565(src, dst, pixels);
+}
+
+void rgb888ToRgb565(const uint8_t *src, uint8_t *dst, int pixels) {
+  activeKernels().rgb888ToRgb565(src, dst, pixels);
+}
+
+void rgba8888ToRgb565Ordered(const uint8_t *src, uint8_t *dst, int pixels,
+                             int row) {
+  activeKernels().rgba8888ToRgb565Ordered(src, dst, pixels, row);
+}
+
+void rgb888ToRgb565Ordered(const uint8_t *src, uint8_t *dst, int pixels,
+                           int row) {
+  activeKernels().rgb888ToRgb565Ordered(src, dst, pixels, row);
+}
+
+void swapRgb565(const uint8_t *src, uint8_t *dst, int pixels) {
+  activeKernels().swapRgb565(src, dst, pixels);
+}
+
+void resampleHorizontal(const uint8_t *src, uint8_t *dst, int dstWidth,
+                        const int *starts, int taps, const int16_t *weights) {
+  activeKernels().resampleHorizontal(src, dst, dstWidth, starts, taps,
+                                     weights);
+}
+
+void resampleVertical(const uint8_t *src, int srcStride, int taps,
+                      const int16_t *weights, uint8_t *dst, int bytes) {
+  activeKernels().resampleVertical(src, srcStride, taps, weights, dst, bytes);
+}
+
+void floydSteinbergToRgb565(const uint8_t *src, int srcStride,
+                            int bytesPerPixel, uint8_t *dst, int dstStride,
+                            int width, int height) {
+  static const int kBits[3] = {5, 6, 5};
+
+  // Accumulated error per channel in 1/16 units for the current and next
+  // row, padded by one pixel on each side so the kernel needs no edge tests.
+  std::vector<int> current((width + 2) * 3, 0);
+  std::vector<int> next((width + 2) * 3, 0);
+
+  for (int y = 0; y < height; ++y) {
+    const uint8_t *srcRow = src + y * srcStride;
+    uint8_t *dstRow = dst + y * dstStride;
+    std::fill(next.begin(), next.end(), 0);
+
+    // Alternate direction each row so the error does not drift sideways
+    const bool leftToRight = (y % 2) == 0;
+    const int dir = leftToRight ? 1 : -1;
+
+    for (int n = 0; n < width; ++n) {
+      const int x = leftToRight ? n : width - 1 - n;
+      const uint8_t *p = srcRow + x * bytesPerPixel;
+      int level[3];
+
+      for (int c = 0; c < 3; ++c) {
+        const int idx = (x + 1) * 3 + c;
+        int v = p[c] + ((current[idx] + 8) >> 4);
+        v = std::min(255, std::max(0, v));
+
+        int shown;
+        level[c] = quantizeChannel(v, kBits[c], shown);
+        const int err = v - shown;
+
+        current[idx + dir * 3] += err * 7;
+        next[idx - dir * 3] += err * 3;
+        next[idx] += err * 5;
+        next[idx + dir * 3] += err;
+      }
+
+      store565(dstRow + 2 * x,
+               static_cast<uint16_t>((level[0] << 11) | (level[1] << 5) |
+                                     level[2]));
+    }
+
+    current.swap(next);
+  }
+}
+
+void rgba8888ToRgb565(Isa isa, const uint8_t *src, uint8_t *dst, int pixels) {
+  kernelsFor(isa).rgba8888ToRgb565(src, dst, pixels);
+}
+
+void rgb888ToRgb565(Isa isa, const uint8_t *src, uint8_t *dst, int pixels) {
+  kernelsFor(isa).rgb888ToRgb565(src, dst, pixels);
+}
+
+void rgba8888ToRgb565Ordered(Isa isa, const uint8_t *src, uint8_t *dst,
+                             int pixels, int row) {
+  kernelsFor(isa).rgba8888ToRgb565Ordered(src, dst, pixels, row);
+}
+
+void rgb888ToRgb565Ordered(Isa isa, const uint8_t *src, uint8_t *dst,
+                           int pixels, int row) {
+  kernelsFor(isa).rgb888ToRgb565Ordered(src, dst, pixels, row);
+}
+
+void swapRgb565(Isa isa, const uint8_t *src, uint8_t *dst, int pixels) {
+  kernelsFor(isa).swapRgb565(src, dst, pixels);
+}
+
+void resampleHorizontal(Isa isa, const uint8_t *src, uint8_t *dst,
+                        int dstWidth, const int *starts, int taps,
+                        const int16_t *weights) {
+  kernelsFor(isa).resampleHorizontal(src, dst, dstWidth, starts, taps,
+                                     weights);
+}
+
+void resampleVertical(Isa isa, const uint8_t *src, int srcStride, int taps,
+                      const int16_t *weights, uint8_t *dst, int bytes) {
+  kernelsFor(isa).resampleVertical(src, srcStride, taps, weights, dst, bytes);
+}
+
+} // namespace PixelKernels
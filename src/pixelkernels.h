@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+
+// Pixel conversion kernels used by LVGLImageConverter. Every kernel has a
+// scalar reference implementation plus SSE2/AVX2 (x86) and NEON (ARM) paths
+// that produce bit-identical output; the fastest path the CPU supports is
+// picked once at runtime.
+namespace PixelKernels {
+
+enum class Isa { Scalar, SSE2, AVX2, NEON };
+
+const char *isaName(Isa isa);
+bool isIsaSupported(Isa isa);
+Isa activeIsa();
+
+// RGB565 output is little-endian, two bytes per pixel, as LVGL stores it.
+void rgba8888ToRgb565(const uint8_t *src, uint8_t *dst, int pixels);
+void rgb888ToRgb565(const uint8_t *src, uint8_t *dst, int pixels);
+
+// Same conversions with 4x4 Bayer ordered dithering. `row` is the image row
+// the pixels belong to and `src` must point at the start of that row, since
+// the threshold pattern depends on both coordinates.
+void rgba8888ToRgb565Ordered(const uint8_t *src, uint8_t *dst, int pixels,
+                             int row);
+void rgb888ToRgb565Ordered(const uint8_t *src, uint8_t *dst, int pixels,
+                           int row);
+
+// Swaps the two bytes of every RGB565 pixel, giving the big-endian order
+// SPI panels expect (LV_COLOR_FORMAT_RGB565_SWAPPED). Works in place.
+void swapRgb565(const uint8_t *src, uint8_t *dst, int pixels);
+
+// Separable resampling passes over RGBA8888 (see ImageResampler for the
+// filter weights). Weights are signed fixed point with
+// kResampleWeightBits fractional bits; results are rounded and clamped.
+const int kResampleWeightBits = 14;
+
+// One row: output pixel x is the sum of `taps` source pixels starting at
+// starts[x], weighted by weights[x * taps + k].
+void resampleHorizontal(const uint8_t *src, uint8_t *dst, int dstWidth,
+                        const int *starts, int taps, const int16_t *weights);
+// One output row of `bytes` bytes from `taps` consecutive source rows.
+void resampleVertical(const uint8_t *src, int srcStride, int taps,
+                      const int16_t *weights, uint8_t *dst, int bytes);
+
+// Floyd-Steinberg error diffusion over a whole image (serpentine scan).
+// Inherently sequential, so there is only a scalar implementation.
+void floydSteinbergToRgb565(const uint8_t *src, int srcStride,
+                            int bytesPerPixel, uint8_t *dst, int dstStride,
+                            int width, int height);
+
+// Explicit-path variants for benchmarks and cross-checking. `isa` must be
+// supported by the running CPU.
+void rgba8888ToRgb565(Isa isa, const uint8_t *src, uint8_t *dst, int pixels);
+void rgb888ToRgb565(Isa isa, const uint8_t *src, uint8_t *dst, int pixels);
+void rgba8888ToRgb565Ordered(Isa isa, const uint8_t *src, uint8_t *dst,
+                             int pixels, int row);
+void rgb888ToRgb565Ordered(Isa isa, const uint8_t *src, uint8_t *dst,
+                           int pixels, int row);
+void swapRgb565(Isa isa, const uint8_t *src, uint8_t *dst, int pixels);
+void resampleHorizontal(Isa isa, const uint8_t *src, uint8_t *dst,
+                        int dstWidth, const int *starts, int taps,
+                        const int16_t *weights);
+void resampleVertical(Isa isa, const uint8_t *src, int srcStride, int taps,
+                      const int16_t *weights, uint8_t *dst, int bytes);
+
+} // namespace PixelKernels
@@ -0,0 +1,207 @@
+#include "processrunner.h"
+#include <QDebug>
+#include <QRegularExpression>
+#include <QTimer>
+
+ProcessRunner::ProcessRunner(QObject *parent)
+    : QObject(parent), m_process(new QProcess(this)),
+      m_timeoutTimer(new QTimer(this)), m_idleTimer(new QTimer(this)) {
+  m_timeoutTimer->setSingleShot(true);
+  m_idleTimer->setSingleShot(true);
+
+  connect(m_process, &QProcess::started, this,
+          [this]() { m_result.started = true; });
+  connect(m_process, &QProcess::readyReadStandardOutput, this,
+          [this]() { onReadyRead(QProcess::StandardOutput); });
+  connect(m_process, &QProcess::readyReadStandardError, this,
+          [this]() { onReadyRead(QProcess::StandardError); });
+  connect(m_process, &QProcess::finished, this,
+          &ProcessRunner::onProcessFinished);
+  connect(m_process, &QProcess::errorOccurred, this,
+          &ProcessRunner::onErrorOccurred);
+  connect(m_timeoutTimer, &QTimer::timeout, this,
+          [this]() { onTimeout(false); });
+  connect(m_idleTimer, &QTimer::timeout, this, [this]() { onTimeout(true); });
+}
+
+ProcessRunner::~ProcessRunner() {
+  // Nothing is reported from a destructor; just do not leave the process
+  // running behind the app
+  disconnect(m_process, nullptr, this, nullptr);
+  if (m_process->state() != QProcess::NotRunning) {
+    m_process->kill();
+    m_process->waitForFinished(3000);
+  }
+}
+
+void ProcessRunner::setWorkingDirectory(const QString &directory) {
+  m_process->setWorkingDirectory(directory);
+}
+
+void ProcessRunner::setProcessEnvironment(
+    const QProcessEnvironment &environment) {
+  m_process->setProcessEnvironment(environment);
+}
+
+void ProcessRunner::setProgressFormat(ProgressFormat format) {
+  m_format = format;
+}
+
+void ProcessRunner::setTimeouts(int totalMs, int idleMs) {
+  m_timeoutMs = totalMs;
+  m_idleTimeoutMs = idleMs;
+}
+
+void ProcessRunner::start(const QString &program,
+                          const QStringList &arguments) {
+  if (m_running) {
+    qDebug() << "ProcessRunner: already running, not starting" << program;
+    return;
+  }
+
+  m_result = Result();
+  m_pending[0].clear();
+  m_pending[1].clear();
+  m_lastPercent = -1;
+  m_running = true;
+  m_elapsed.start();
+  if (m_timeoutMs > 0) {
+    m_timeoutTimer->start(m_timeoutMs);
+  }
+  if (m_idleTimeoutMs > 0) {
+    m_idleTimer->start(m_idleTimeoutMs);
+  }
+  m_process->start(program, arguments);
+}
+
+void ProcessRunner::cancel() {
+  if (!m_running) {
+    return;
+  }
+  m_result.canceled = true;
+  m_result.errorString = "Canceled";
+  m_process->kill();
+}
+
+bool ProcessRunner::isRunning() const { return m_running; }
+
+int ProcessRunner::parseProgress(ProgressFormat format, const QString &line) {
+  switch (format) {
+  case ProgressFormat::None:
+    return -1;
+  case ProgressFormat::Ninja: {
+    static const QRegularExpression status("^\\[(\\d+)/(\\d+)\\]");
+    const QRegularExpressionMatch match = status.match(line);
+    const qint64 total = match.hasMatch() ? match.captured(2).toLongLong() : 0;
+    if (total <= 0) {
+      return -1;
+    }
+    return int(qBound<qint64>(0, match.captured(1).toLongLong() * 100 / total,
+                              100));
+  }
+  case ProgressFormat::Nrfutil: {
+    static const QRegularExpression json(
+        "\"progress_?percentage\"\\s*:\\s*(\\d+)",
+        QRegularExpression::CaseInsensitiveOption);
+    static const QRegularExpression text("(\\d{1,3})\\s*%");
+    QRegularExpressionMatch match = json.match(line);
+    if (!match.hasMatch()) {
+      match = text.match(line);
+    }
+    if (!match.hasMatch()) {
+      return -1;
+    }
+    return qBound(0, match.captured(1).toInt(), 100);
+  }
+  }
+  return -1;
+}
+
+void ProcessRunner::onReadyRead(QProcess::ProcessChannel channel) {
+  const bool isError = channel == QProcess::StandardError;
+  QByteArray &pending = m_pending[isError ? 1 : 0];
+  pending += isError ? m_process->readAllStandardError()
+                     : m_process->readAllStandardOutput();
+  if (m_idleTimeoutMs > 0) {
+    m_idleTimer->start(m_idleTimeoutMs);
+  }
+
+  int lineStart = 0;
+  for (int i = 0; i < pending.size(); ++i) {
+    if (pending[i] == '\n' || pending[i] == '\r') {
+      if (i > lineStart) {
+        handleLine(QString::fromLocal8Bit(pending.mid(lineStart, i - lineStart)),
+                   isError);
+      }
+      lineStart = i + 1;
+    }
+  }
+  pending.remove(0, lineStart);
+}
+
+void ProcessRunner::flushPartialLines() {
+  onReadyRead(QProcess::StandardOutput);
+  onReadyRead(QProcess::StandardError);
+  for (int channel = 0; channel < 2; ++channel) {
+    if (!m_pending[channel].isEmpty()) {
+      handleLine(QString::fromLocal8Bit(m_pending[channel]), channel == 1);
+      m_pending[channel].clear();
+    }
+  }
+}
+
+void ProcessRunner::handleLine(const QString &line, bool isError) {
+  QString &log = isError ? m_result.errorOutput : m_result.output;
+  log += line;
+  log += '\n';
+  emit lineReceived(line, isError);
+
+  const int percent = parseProgress(m_format, line);
+  if (percent >= 0 && percent != m_lastPercent) {
+    m_lastPercent = percent;
+    emit progressChanged(percent, line);
+  }
+}
+
+void ProcessRunner::onProcessFinished(int exitCode,
+                                      QProcess::ExitStatus exitStatus) {
+  if (!m_running) {
+    return;
+  }
+  flushPartialLines();
+  m_result.exitCode = exitCode;
+  m_result.exitStatus = exitStatus;
+  finish();
+}
+
+void ProcessRunner::onErrorOccurred(QProcess::ProcessError error) {
+  if (m_result.errorString.isEmpty()) {
+    m_result.errorString = m_process->errorString();
+  }
+  // The only error not followed by finished()
+  if (error == QProcess::FailedToStart && m_running) {
+    finish();
+  }
+}
+
+void ProcessRunner::onTimeout(bool idle) {
+  if (!m_running) {
+    return;
+  }
+  m_result.timedOut = true;
+  m_result.errorString =
+      idle ? QString("No output for %1 s").arg(m_idleTimeoutMs / 1000)
+           : QString("Timed out after %1 s").arg(m_timeoutMs / 1000);
+  m_process->kill();
+}
+
+void ProcessRunner::finish() {
+  m_timeoutTimer->stop();
+  m_idleTimer->stop();
+  m_running = false;
+  m_result.milliseconds = m_elapsed.elapsed();
+  // Queued, so a handler can start() the next process without re-entering
+  // the QProcess that is still delivering its signals
+  QMetaObject::invokeMethod(this, &ProcessRunner::finished,
+                            Qt::QueuedConnection);
+}
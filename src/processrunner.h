@@ -0,0 +1,96 @@
+#pragma once
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QProcess>
+#include <QProcessEnvironment>
+#include <QString>
+#include <QStringList>
+
+class QTimer;
+
+// Runs one external process at a time without blocking the calling thread.
+//
+// stdout and stderr are split into lines as they arrive (a carriage return
+// ends a line too, so redrawn progress bars are seen), logged, and matched
+// against the progress format of the tool being run. A run is killed when
+// it exceeds its timeout or prints nothing for its idle timeout. finished()
+// follows every start() exactly once, from the event loop, also when the
+// program cannot be started.
+class ProcessRunner : public QObject {
+  Q_OBJECT
+
+public:
+  // How a percentage is read from the output
+  enum class ProgressFormat {
+    None,
+    // "[12/250] Building C object ..." status lines
+    Ninja,
+    // "progressPercentage": 42 in --json output, or "42%" in plain text
+    Nrfutil,
+  };
+
+  struct Result {
+    bool started = false;
+    bool timedOut = false;
+    bool canceled = false;
+    QProcess::ExitStatus exitStatus = QProcess::NormalExit;
+    int exitCode = -1;
+    QString output;
+    QString errorOutput;
+    QString errorString;
+    qint64 milliseconds = 0;
+
+    bool succeeded() const {
+      return started && !timedOut && !canceled &&
+             exitStatus == QProcess::NormalExit && exitCode == 0;
+    }
+  };
+
+  explicit ProcessRunner(QObject *parent = nullptr);
+  ~ProcessRunner();
+
+  void setWorkingDirectory(const QString &directory);
+  void setProcessEnvironment(const QProcessEnvironment &environment);
+  void setProgressFormat(ProgressFormat format);
+  // Limits for the next start(), in milliseconds; 0 disables a limit
+  void setTimeouts(int totalMs, int idleMs);
+
+  void start(const QString &program, const QStringList &arguments);
+  // Kills the running process; finished() still follows
+  void cancel();
+  bool isRunning() const;
+
+  // Valid once finished() has been emitted
+  const Result &result() const { return m_result; }
+
+  // Percentage (0..100) reported by `line`, or -1 if it reports none
+  static int parseProgress(ProgressFormat format, const QString &line);
+
+signals:
+  void lineReceived(const QString &line, bool isError);
+  // Only emitted when the percentage changes
+  void progressChanged(int percent, const QString &line);
+  void finished();
+
+private:
+  void onReadyRead(QProcess::ProcessChannel channel);
+  void onProcessFinished(int exitCode, QProcess::ExitStatus exitStatus);
+  void onErrorOccurred(QProcess::ProcessError error);
+  void onTimeout(bool idle);
+  void flushPartialLines();
+  void handleLine(const QString &line, bool isError);
+  void finish();
+
+  QProcess *m_process;
+  QTimer *m_timeoutTimer;
+  QTimer *m_idleTimer;
+  QElapsedTimer m_elapsed;
+  ProgressFormat m_format = ProgressFormat::None;
+  int m_timeoutMs = 0;
+  int m_idleTimeoutMs = 0;
+  int m_lastPercent = -1;
+  bool m_running = false;
+  QByteArray m_pending[2];
+  Result m_result;
+};
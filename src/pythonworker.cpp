@@ -0,0 +1,401 @@
+#include "pythonworker.h"
+#include <QCoreApplication>
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QMutexLocker>
+#include <QProcess>
+#include <QThread>
+
+namespace {
+
+// Request loop executed by the embedded interpreter. Replies go over a
+// private duplicate of stdout; fd 1 itself is pointed at stderr so prints from
+// scripts or child processes (e.g. pngquant) cannot corrupt the protocol.
+const char* kWorkerScript = R"PY(import contextlib
+import importlib
+import io
+import json
+import os
+import platform
+import runpy
+import sys
+import traceback
+
+_reply = os.fdopen(os.dup(1), "w", encoding="utf-8")
+os.dup2(2, 1)
+sys.stdout = sys.stderr
+sys.stdin.reconfigure(encoding="utf-8")
+
+
+def _send(message):
+    _reply.write(json.dumps(message) + "\n")
+    _reply.flush()
+
+
+def _run(request):
+    script = request["script"]
+    out, err = io.StringIO(), io.StringIO()
+    exit_code = 0
+    saved_argv, saved_path = sys.argv, list(sys.path)
+    sys.argv = [script] + list(request.get("args", []))
+    sys.path.insert(0, os.path.dirname(os.path.abspath(script)))
+    try:
+        with contextlib.redirect_stdout(out), contextlib.redirect_stderr(err):
+            try:
+                runpy.run_path(script, run_name="__main__")
+            except SystemExit as e:
+                if e.code is None:
+                    exit_code = 0
+                elif isinstance(e.code, int):
+                    exit_code = e.code
+                else:
+                    print(e.code, file=sys.stderr)
+                    exit_code = 1
+            except BaseException:
+                traceback.print_exc()
+                exit_code = 1
+    finally:
+        sys.argv = saved_argv
+        sys.path[:] = saved_path
+    return {"exit_code": exit_code, "stdout": out.getvalue(), "stderr": err.getvalue()}
+
+
+def _probe(request):
+    importlib.invalidate_caches()
+    missing = {}
+    for module in request.get("modules", []):
+        try:
+            importlib.import_module(module)
+        except Exception as e:
+            missing[module] = "%s: %s" % (type(e).__name__, e)
+    return {"missing": missing}
+
+
+def _versions(request):
+    from importlib import metadata
+    packages = {}
+    for name in request.get("packages", []):
+        try:
+            packages[name] = metadata.version(name)
+        except Exception:
+            packages[name] = None
+    return {"python": platform.python_version(), "packages": packages}
+
+
+_HANDLERS = {
+    "ping": lambda request: {},
+    "run": _run,
+    "probe": _probe,
+    "versions": _versions,
+}
+
+while True:
+    line = sys.stdin.readline()
+    if not line:
+        break
+    line = line.strip()
+    if not line:
+        continue
+    try:
+        request = json.loads(line)
+    except ValueError as e:
+        _send({"ok": False, "error": "bad request: %s" % e})
+        continue
+    handler = _HANDLERS.get(request.get("cmd"))
+    if handler is None:
+        response = {"ok": False, "error": "unknown command"}
+    else:
+        try:
+            response = handler(request)
+            response["ok"] = True
+        except BaseException as e:
+            response = {"ok": False, "error": "".join(
+                traceback.format_exception_only(type(e), e)).strip()}
+    response["id"] = request.get("id")
+    _send(response)
+)PY";
+
+QJsonObject failure(const QString& error)
+{
+    QJsonObject response;
+    response["ok"] = false;
+    response["error"] = error;
+    return response;
+}
+
+} // namespace
+
+// Owns the QProcess; lives on PythonWorker's thread and is only ever called
+// there, so it needs no locking of its own.
+class PythonWorkerSession : public QObject
+{
+public:
+    ~PythonWorkerSession() { stop(); }
+
+    QJsonObject request(const QString& pythonExe, QJsonObject req, int timeoutMs)
+    {
+        // One retry: if the interpreter crashed since the last request (or
+        // while handling this one) it is restarted and the request resent.
+        for (int attempt = 0; attempt < 2; ++attempt) {
+            QString error;
+            if (!ensureStarted(pythonExe, error)) {
+                return failure(error);
+            }
+
+            const int id = m_nextId++;
+            req["id"] = id;
+            m_process->write(QJsonDocument(req).toJson(QJsonDocument::Compact) + '\n');
+
+            QJsonObject response;
+            const ReadResult result = readResponse(id, timeoutMs, response);
+            if (result == ReadResult::Ok) {
+                return response;
+            }
+
+            stop();
+            if (result == ReadResult::TimedOut) {
+                // A hung script would just hang again
+                return failure(QString("Python worker timed out after %1 ms").arg(timeoutMs));
+            }
+            qDebug() << "Python worker exited unexpectedly, restarting";
+        }
+        return failure("Python worker crashed");
+    }
+
+    void stop()
+    {
+        if (!m_process) {
+            return;
+        }
+        if (m_process->state() != QProcess::NotRunning) {
+            m_process->closeWriteChannel();
+            if (!m_process->waitForFinished(1000)) {
+                m_process->kill();
+                m_process->waitForFinished(1000);
+            }
+        }
+        delete m_process;
+        m_process = nullptr;
+        m_buffer.clear();
+    }
+
+private:
+    enum class ReadResult { Ok, TimedOut, Exited };
+
+    bool ensureStarted(const QString& pythonExe, QString& error)
+    {
+        if (m_process && m_process->state() == QProcess::Running && m_pythonExe == pythonExe) {
+            return true;
+        }
+        stop();
+
+        m_process = new QProcess(this);
+        // stderr carries script tracebacks and stray prints; forward it to
+        // our console instead of letting the pipe fill up and block Python.
+        m_process->setProcessChannelMode(QProcess::ForwardedErrorChannel);
+        m_process->start(pythonExe, {"-u", PythonWorker::workerScriptPath()});
+        if (!m_process->waitForStarted(5000)) {
+            error = QString("Failed to start Python worker: %1").arg(m_process->errorString());
+            stop();
+            return false;
+        }
+
+        m_pythonExe = pythonExe;
+        qDebug() << "Started Python worker:" << pythonExe << "pid" << m_process->processId();
+        return true;
+    }
+
+    ReadResult readResponse(int id, int timeoutMs, QJsonObject& response)
+    {
+        QElapsedTimer timer;
+        timer.start();
+
+        for (;;) {
+            int newline;
+            while ((newline = m_buffer.indexOf('\n')) >= 0) {
+                const QByteArray line = m_buffer.left(newline);
+                m_buffer.remove(0, newline + 1);
+
+                const QJsonObject reply = QJsonDocument::fromJson(line).object();
+                if (reply.value("id").toInt(-1) == id) {
+                    response = reply;
+                    return ReadResult::Ok;
+                }
+                // Stale reply from a request that timed out earlier
+                qDebug() << "Ignoring unexpected Python worker reply:" << line.left(200);
+            }
+
+            const qint64 remaining = timeoutMs - timer.elapsed();
+            if (remaining <= 0) {
+                return ReadResult::TimedOut;
+            }
+            if (m_process->state() == QProcess::NotRunning) {
+                return ReadResult::Exited;
+            }
+            if (m_process->waitForReadyRead(static_cast<int>(remaining))) {
+                m_buffer.append(m_process->readAllStandardOutput());
+            } else if (m_process->state() == QProcess::NotRunning) {
+                return ReadResult::Exited;
+            }
+        }
+    }
+
+    QProcess* m_process = nullptr;
+    QString m_pythonExe;
+    QByteArray m_buffer;
+    int m_nextId = 1;
+};
+
+PythonWorker& PythonWorker::instance()
+{
+    static PythonWorker worker;
+    return worker;
+}
+
+PythonWorker::PythonWorker()
+    : m_thread(nullptr)
+    , m_session(nullptr)
+{
+    if (QCoreApplication::instance()) {
+        // The thread must be gone before QApplication is destroyed
+        QObject::connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit,
+                         [this]() { shutdown(); });
+    }
+}
+
+PythonWorker::~PythonWorker()
+{
+    shutdown();
+}
+
+QString PythonWorker::workerScriptPath()
+{
+    QString appDir = QCoreApplication::applicationDirPath();
+    return appDir + "/libraries/python/lcd_tester_worker.py";
+}
+
+bool PythonWorker::ensureWorkerScript()
+{
+    const QString scriptPath = workerScriptPath();
+    const QByteArray script(kWorkerScript);
+
+    QFile existing(scriptPath);
+    if (existing.open(QIODevice::ReadOnly) && existing.readAll() == script) {
+        return true;
+    }
+    existing.close();
+
+    QDir().mkpath(QFileInfo(scriptPath).absolutePath());
+    QFile file(scriptPath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qDebug() << "Failed to write Python worker script:" << scriptPath;
+        return false;
+    }
+    file.write(script);
+    return true;
+}
+
+QJsonObject PythonWorker::request(const QString& pythonExe, const QJsonObject& req, int timeoutMs)
+{
+    QMutexLocker locker(&m_mutex);
+
+    if (!m_thread) {
+        if (!ensureWorkerScript()) {
+            return failure("Python worker script could not be written");
+        }
+        m_thread = new QThread;
+        m_thread->setObjectName("PythonWorker");
+        m_session = new PythonWorkerSession;
+        m_session->moveToThread(m_thread);
+        m_thread->start();
+    }
+
+    QJsonObject response;
+    QMetaObject::invokeMethod(m_session, [&]() {
+        response = m_session->request(pythonExe, req, timeoutMs);
+    }, Qt::BlockingQueuedConnection);
+    return response;
+}
+
+void PythonWorker::shutdown()
+{
+    QMutexLocker locker(&m_mutex);
+
+    if (!m_thread) {
+        return;
+    }
+
+    // The QProcess must be torn down on the thread that created it
+    PythonWorkerSession* session = m_session;
+    QMetaObject::invokeMethod(session, [session]() { session->stop(); },
+                              Qt::BlockingQueuedConnection);
+    m_thread->quit();
+    m_thread->wait();
+    delete session;
+    delete m_thread;
+    m_thread = nullptr;
+    m_session = nullptr;
+}
+
+bool PythonWorker::ping(const QString& pythonExe)
+{
+    QJsonObject req;
+    req["cmd"] = "ping";
+    return request(pythonExe, req, 10000).value("ok").toBool();
+}
+
+bool PythonWorker::runScript(const QString& pythonExe, const QString& scriptPath,
+                             const QStringList& arguments, QString& output, QString& error,
+                             int timeoutMs)
+{
+    QJsonObject req;
+    req["cmd"] = "run";
+    req["script"] = scriptPath;
+    req["args"] = QJsonArray::fromStringList(arguments);
+
+    const QJsonObject response = request(pythonExe, req, timeoutMs);
+    if (!response.value("ok").toBool()) {
+        output.clear();
+        error = response.value("error").toString();
+        return false;
+    }
+
+    output = response.value("stdout").toString();
+    error = response.value("stderr").toString();
+    return response.value("exit_code").toInt(1) == 0;
+}
+
+QJsonObject PythonWorker::probeImports(const QString& pythonExe, const QStringList& modules)
+{
+    QJsonObject req;
+    req["cmd"] = "probe";
+    req["modules"] = QJsonArray::fromStringList(modules);
+
+    const QJsonObject response = request(pythonExe, req, 15000);
+    if (!response.value("ok").toBool()) {
+        // Worker unusable: report every module as missing
+        QJsonObject missing;
+        for (const QString& module : modules) {
+            missing[module] = response.value("error").toString();
+        }
+        return missing;
+    }
+    return response.value("missing").toObject();
+}
+
+QJsonObject PythonWorker::versions(const QString& pythonExe, const QStringList& packages)
+{
+    QJsonObject req;
+    req["cmd"] = "versions";
+    req["packages"] = QJsonArray::fromStringList(packages);
+
+    QJsonObject response = request(pythonExe, req, 15000);
+    response.remove("id");
+    response.remove("ok");
+    return response;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <QJsonObject>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+
+class QThread;
+class PythonWorkerSession;
+
+// Long-lived embedded-Python process shared by the whole application.
+//
+// The interpreter is started on first use and then reused: requests are sent
+// as one JSON object per line on stdin and answered the same way on stdout.
+// Supported commands are "run" (execute a script such as LVGLImage.py with
+// arguments), "probe" (test module imports), "versions" and "ping". If the
+// process dies it is restarted transparently on the next request.
+//
+// All methods are thread-safe and block the caller until the reply arrives;
+// the QProcess itself lives on a dedicated thread.
+class PythonWorker
+{
+public:
+    static PythonWorker& instance();
+
+    bool ping(const QString& pythonExe);
+    bool runScript(const QString& pythonExe, const QString& scriptPath,
+                   const QStringList& arguments, QString& output, QString& error,
+                   int timeoutMs = 30000);
+    // Returns the subset of `modules` that failed to import (module -> error)
+    QJsonObject probeImports(const QString& pythonExe, const QStringList& modules);
+    // {"python": "3.11.9", "packages": {"Pillow": "10.3.0", ...}}
+    QJsonObject versions(const QString& pythonExe, const QStringList& packages);
+
+    // Stops the interpreter; the next request starts a fresh one. Used after
+    // pip changes the environment and on application exit.
+    void shutdown();
+
+    static QString workerScriptPath();
+
+private:
+    PythonWorker();
+    ~PythonWorker();
+    PythonWorker(const PythonWorker&) = delete;
+    PythonWorker& operator=(const PythonWorker&) = delete;
+
+    QJsonObject request(const QString& pythonExe, const QJsonObject& req, int timeoutMs);
+    bool ensureWorkerScript();
+
+    QMutex m_mutex;
+    QThread* m_thread;
+    PythonWorkerSession* m_session;
+};
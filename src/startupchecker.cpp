@@ -38,6 +38,7 @@ bool StartupChecker::performStartupCheck()
 
     if (success) {
         qDebug() << "All components setup successfully";
+        m_embeddedPython->logPackageVersions(EmbeddedPython::requiredPackages());
     } else {
         qDebug() << "Failed to setup some components";
     }
@@ -117,30 +118,8 @@ StartupChecker::MissingComponents StartupChecker::checkAllComponents()
         qDebug() << "Embedded Python found";
 
         // Check Python packages if Python is available
-        QString pythonExe = m_embeddedPython->getEmbeddedPythonPath();
-        QStringList requiredPackages = {"Pillow", "pypng", "lz4", "kconfiglib"};
-
-        for (const QString& package : requiredPackages) {
-            // Test each package
-            QString testCommand;
-            if (package == "Pillow") {
-                testCommand = "import PIL.Image";
-            } else if (package == "lz4") {
-                testCommand = "import lz4.block";
-            } else {
-                testCommand = QString("import %1").arg(package == "pypng" ? "png" : package);
-            }
-
-            QProcess testProcess;
-            testProcess.start(pythonExe, {"-c", testCommand});
-            testProcess.waitForFinished(5000);
-
-            if (testProcess.exitCode() != 0) {
-                missing.needsPythonPackages = true;
-                missing.missingPackages.append(package);
-                qDebug() << "Missing Python package:" << package;
-            }
-        }
+        missing.missingPackages = m_embeddedPython->findMissingPackages(EmbeddedPython::requiredPackages());
+        missing.needsPythonPackages = !missing.missingPackages.isEmpty();
 
         if (missing.missingPackages.isEmpty()) {
             qDebug() << "All Python packages are available";
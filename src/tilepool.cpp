@@ -0,0 +1,58 @@
+#include "tilepool.h"
+#include <algorithm>
+#include <cstring>
+
+bool TilePool::canTile(const LVGLImageConverter::EncodedImage &encoded) {
+  if (encoded.compression != LVGLImageConverter::Compression::None) {
+    return false;
+  }
+  switch (encoded.colorFormat) {
+  case LVGLImageConverter::ColorFormat::RGB565:
+  case LVGLImageConverter::ColorFormat::RGB888:
+  case LVGLImageConverter::ColorFormat::L8:
+  case LVGLImageConverter::ColorFormat::A8:
+    return true;
+  default:
+    return false;
+  }
+}
+
+QVector<quint32>
+TilePool::add(const LVGLImageConverter::EncodedImage &encoded) {
+  const int pixelBytes =
+      LVGLImageConverter::bitsPerPixel(encoded.colorFormat) / 8;
+  const int tileRowBytes = kTileSize * pixelBytes;
+  const int columns = (encoded.width + kTileSize - 1) / kTileSize;
+  const int rows = (encoded.height + kTileSize - 1) / kTileSize;
+
+  QVector<quint32> offsets;
+  offsets.reserve(columns * rows);
+  QByteArray tile(tileRowBytes * kTileSize, '\0');
+
+  for (int ty = 0; ty < rows; ++ty) {
+    for (int tx = 0; tx < columns; ++tx) {
+      const int x = tx * kTileSize;
+      const int y = ty * kTileSize;
+      const int copyRows = std::min(kTileSize, encoded.height - y);
+      const int copyBytes = std::min(kTileSize, encoded.width - x) * pixelBytes;
+
+      // Padding stays zero so partial edge tiles still match each other
+      tile.fill('\0');
+      for (int r = 0; r < copyRows; ++r) {
+        std::memcpy(tile.data() + r * tileRowBytes,
+                    encoded.data.constData() + (y + r) * encoded.stride +
+                        x * pixelBytes,
+                    copyBytes);
+      }
+
+      auto it = m_offsets.constFind(tile);
+      if (it == m_offsets.constEnd()) {
+        it = m_offsets.insert(tile, quint32(m_data.size()));
+        m_data.append(tile);
+      }
+      offsets.append(it.value());
+      ++m_tilesAdded;
+    }
+  }
+  return offsets;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "lvglimageconverter.h"
+#include <QByteArray>
+#include <QHash>
+#include <QVector>
+
+// Deduplicated store of fixed-size pixel tiles shared by a set of images.
+//
+// Images are cut into kTileSize x kTileSize tiles (edge tiles zero-padded),
+// each distinct tile is stored once, and every image becomes a row-major map
+// of byte offsets into the pool. Screens that share headers, footers and
+// backgrounds then only pay for those regions once. The firmware composites
+// an image back into RAM with generated_image_compose() from
+// generated_images.h.
+class TilePool {
+public:
+  static const int kTileSize = 16;
+
+  // Tiling works on whole bytes per pixel: uncompressed RGB565, RGB888, L8
+  // and A8. Planar, indexed and compressed images are stored whole.
+  static bool canTile(const LVGLImageConverter::EncodedImage &encoded);
+
+  // Adds the tiles of `encoded` and returns their offsets in data()
+  QVector<quint32> add(const LVGLImageConverter::EncodedImage &encoded);
+
+  const QByteArray &data() const { return m_data; }
+  int tileCount() const { return m_offsets.size(); }
+  int tilesAdded() const { return m_tilesAdded; }
+
+private:
+  QByteArray m_data;
+  QHash<QByteArray, quint32> m_offsets;
+  int m_tilesAdded = 0;
+};